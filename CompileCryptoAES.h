@@ -0,0 +1,2499 @@
+#pragma once
+
+#ifndef _COMPILECRYPTOAES_H_
+#define _COMPILECRYPTOAES_H_
+
+#include <type_traits>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+// ----------------------------------------------------------------
+// General definitions
+// ----------------------------------------------------------------
+
+#if defined(_MSC_VER)
+#define _CRYPTOAES_NO_INLINE __declspec(noinline)
+#define _CRYPTOAES_FORCE_INLINE __forceinline
+#elif defined(__GNUC__) || defined(__clang__)
+#define _CRYPTOAES_NO_INLINE __attribute__((noinline))
+#define _CRYPTOAES_FORCE_INLINE __attribute__((always_inline))
+#else
+#define _CRYPTOAES_NO_INLINE
+#define _CRYPTOAES_FORCE_INLINE inline
+#endif
+
+// Entry points of the runtime engine. They stay out of line so every CRYPTOSTRINGAES/CRYPTOARRAYAES site shares one copy;
+// define CRYPTOAES_INLINE_ENGINE to inline the whole engine into each site instead.
+#if defined(CRYPTOAES_INLINE_ENGINE) && defined(_MSC_VER)
+#define _CRYPTOAES_ENGINE __forceinline
+#elif defined(CRYPTOAES_INLINE_ENGINE)
+#define _CRYPTOAES_ENGINE _CRYPTOAES_FORCE_INLINE inline
+#else
+#define _CRYPTOAES_ENGINE _CRYPTOAES_NO_INLINE inline
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define _CRYPTOAES_TARGET(TARGET) __attribute__((target(TARGET)))
+#else
+#define _CRYPTOAES_TARGET(TARGET)
+#endif
+
+#if !defined(CRYPTOAES_NO_HARDWARE) && !defined(CRYPTOSTRINGAES_NO_HARDWARE) && !defined(CRYPTOARRAYAES_NO_HARDWARE) && (defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__))
+#define _CRYPTOAES_X86
+#endif
+
+#if defined(CRYPTOAES_CONSTANT_TIME) || defined(CRYPTOSTRINGAES_CONSTANT_TIME) || defined(CRYPTOARRAYAES_CONSTANT_TIME)
+#define _CRYPTOAES_CONSTANT_TIME
+#endif
+
+#ifdef _CRYPTOAES_X86
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#include <immintrin.h>
+#endif
+
+// ----------------------------------------------------------------
+// CryptoAES
+// ----------------------------------------------------------------
+
+// AES-GCM (128 or 256-bit keys) shared by CompileCryptoStringAES.h and CompileCryptoArrayAES.h: the constexpr encryptor used by MakeBlob
+// and the runtime decryptor behind every Decrypt().
+namespace CryptoAES {
+
+	template<std::size_t N>
+	struct Bytes {
+		_CRYPTOAES_FORCE_INLINE constexpr unsigned char* data() noexcept { return m_Data; }
+		_CRYPTOAES_FORCE_INLINE constexpr const unsigned char* data() const noexcept { return m_Data; }
+		_CRYPTOAES_FORCE_INLINE constexpr std::size_t size() const noexcept { return N; }
+
+		_CRYPTOAES_FORCE_INLINE constexpr unsigned char& operator[](std::size_t i) noexcept { return m_Data[i]; }
+		_CRYPTOAES_FORCE_INLINE constexpr const unsigned char& operator[](std::size_t i) const noexcept { return m_Data[i]; }
+
+		unsigned char m_Data[N] {};
+	};
+
+	using block16 = Bytes<16>;
+	using block32 = Bytes<32>;
+	using iv12 = Bytes<12>;
+
+	constexpr static unsigned char kAAD[10] = { 'R', 'e', 'n', 'a', 'r', 'd', 'D', 'e', 'v', '\0' }; // RenardDev
+	constexpr static std::size_t kAADSize = sizeof(kAAD);
+
+	constexpr static unsigned char kIBS[256] = {
+		0x63, 0x7C, 0x77, 0x7B, 0xF2, 0x6B, 0x6F, 0xC5, 0x30, 0x01, 0x67, 0x2B, 0xFE, 0xD7, 0xAB, 0x76,
+		0xCA, 0x82, 0xC9, 0x7D, 0xFA, 0x59, 0x47, 0xF0, 0xAD, 0xD4, 0xA2, 0xAF, 0x9C, 0xA4, 0x72, 0xC0,
+		0xB7, 0xFD, 0x93, 0x26, 0x36, 0x3F, 0xF7, 0xCC, 0x34, 0xA5, 0xE5, 0xF1, 0x71, 0xD8, 0x31, 0x15,
+		0x04, 0xC7, 0x23, 0xC3, 0x18, 0x96, 0x05, 0x9A, 0x07, 0x12, 0x80, 0xE2, 0xEB, 0x27, 0xB2, 0x75,
+		0x09, 0x83, 0x2C, 0x1A, 0x1B, 0x6E, 0x5A, 0xA0, 0x52, 0x3B, 0xD6, 0xB3, 0x29, 0xE3, 0x2F, 0x84,
+		0x53, 0xD1, 0x00, 0xED, 0x20, 0xFC, 0xB1, 0x5B, 0x6A, 0xCB, 0xBE, 0x39, 0x4A, 0x4C, 0x58, 0xCF,
+		0xD0, 0xEF, 0xAA, 0xFB, 0x43, 0x4D, 0x33, 0x85, 0x45, 0xF9, 0x02, 0x7F, 0x50, 0x3C, 0x9F, 0xA8,
+		0x51, 0xA3, 0x40, 0x8F, 0x92, 0x9D, 0x38, 0xF5, 0xBC, 0xB6, 0xDA, 0x21, 0x10, 0xFF, 0xF3, 0xD2,
+		0xCD, 0x0C, 0x13, 0xEC, 0x5F, 0x97, 0x44, 0x17, 0xC4, 0xA7, 0x7E, 0x3D, 0x64, 0x5D, 0x19, 0x73,
+		0x60, 0x81, 0x4F, 0xDC, 0x22, 0x2A, 0x90, 0x88, 0x46, 0xEE, 0xB8, 0x14, 0xDE, 0x5E, 0x0B, 0xDB,
+		0xE0, 0x32, 0x3A, 0x0A, 0x49, 0x06, 0x24, 0x5C, 0xC2, 0xD3, 0xAC, 0x62, 0x91, 0x95, 0xE4, 0x79,
+		0xE7, 0xC8, 0x37, 0x6D, 0x8D, 0xD5, 0x4E, 0xA9, 0x6C, 0x56, 0xF4, 0xEA, 0x65, 0x7A, 0xAE, 0x08,
+		0xBA, 0x78, 0x25, 0x2E, 0x1C, 0xA6, 0xB4, 0xC6, 0xE8, 0xDD, 0x74, 0x1F, 0x4B, 0xBD, 0x8B, 0x8A,
+		0x70, 0x3E, 0xB5, 0x66, 0x48, 0x03, 0xF6, 0x0E, 0x61, 0x35, 0x57, 0xB9, 0x86, 0xC1, 0x1D, 0x9E,
+		0xE1, 0xF8, 0x98, 0x11, 0x69, 0xD9, 0x8E, 0x94, 0x9B, 0x1E, 0x87, 0xE9, 0xCE, 0x55, 0x28, 0xDF,
+		0x8C, 0xA1, 0x89, 0x0D, 0xBF, 0xE6, 0x42, 0x68, 0x41, 0x99, 0x2D, 0x0F, 0xB0, 0x54, 0xBB, 0x16
+	};
+
+	constexpr static unsigned int kRCON[15] = {
+		0x00000000, 0x01000000, 0x02000000,
+		0x04000000, 0x08000000, 0x10000000,
+		0x20000000, 0x40000000, 0x80000000,
+		0x1B000000, 0x36000000, 0x6C000000,
+		0xD8000000, 0xAB000000, 0x4D000000
+	};
+
+	constexpr unsigned int rotr32(unsigned int unX, unsigned int unN) noexcept {
+		return (unX >> unN) | (unX << (32u - unN));
+	}
+
+	constexpr unsigned int be32(const unsigned char* pBuffer) noexcept {
+		return (static_cast<unsigned int>(pBuffer[0]) << 24) |
+			   (static_cast<unsigned int>(pBuffer[1]) << 16) |
+			   (static_cast<unsigned int>(pBuffer[2]) <<  8) |
+				static_cast<unsigned int>(pBuffer[3]);
+	}
+
+	constexpr void put_be32(unsigned char* pBuffer, unsigned int unX) noexcept {
+		pBuffer[0] = static_cast<unsigned char>((unX >> 24) & 0xFF);
+		pBuffer[1] = static_cast<unsigned char>((unX >> 16) & 0xFF);
+		pBuffer[2] = static_cast<unsigned char>((unX >>  8) & 0xFF);
+		pBuffer[3] = static_cast<unsigned char>( unX        & 0xFF);
+	}
+
+	// Te0[x] = { 2*S[x], S[x], S[x], 3*S[x] } via xtime, the other three columns are byte rotations of it. Shared by the
+	// constexpr encryptor and the portable runtime path.
+	struct AESTables {
+		constexpr AESTables() noexcept {
+			for (unsigned int i = 0; i < 256; ++i) {
+				const unsigned int unS = kIBS[i];
+				const unsigned int unS2 = ((unS << 1) ^ ((unS & 0x80) ? 0x1B : 0x00)) & 0xFF;
+
+				m_Te0[i] = (unS2 << 24) | (unS << 16) | (unS << 8) | (unS2 ^ unS);
+			}
+		}
+
+		unsigned int m_Te0[256] {};
+	};
+
+	constexpr static AESTables kAESTables {};
+
+	// Final round: SubBytes + ShiftRows for one output column, no MixColumns.
+	constexpr unsigned int AESSubColumn(unsigned int unA, unsigned int unB, unsigned int unC, unsigned int unD) noexcept {
+		return (static_cast<unsigned int>(kIBS[ unA >> 24        ]) << 24) |
+			   (static_cast<unsigned int>(kIBS[(unB >> 16) & 0xFF]) << 16) |
+			   (static_cast<unsigned int>(kIBS[(unC >>  8) & 0xFF]) <<  8) |
+				static_cast<unsigned int>(kIBS[ unD        & 0xFF]);
+	}
+
+	// unRounds is 14 for AES-256 and 10 for AES-128; RK holds 4 * (unRounds + 1) words.
+	template<std::size_t unBlocks>
+	constexpr void AESEncryptTable(const unsigned int RK[60], unsigned int unRounds, unsigned int(&S)[unBlocks][4]) noexcept {
+		const unsigned int* pTe0 = kAESTables.m_Te0;
+
+		for (unsigned int unR = 1; unR < unRounds; ++unR) {
+			for (std::size_t b = 0; b < unBlocks; ++b) {
+				const unsigned int s0 = S[b][0], s1 = S[b][1], s2 = S[b][2], s3 = S[b][3];
+
+				S[b][0] = pTe0[s0 >> 24] ^ rotr32(pTe0[(s1 >> 16) & 0xFF], 8) ^ rotr32(pTe0[(s2 >> 8) & 0xFF], 16) ^ rotr32(pTe0[s3 & 0xFF], 24) ^ RK[4 * unR];
+				S[b][1] = pTe0[s1 >> 24] ^ rotr32(pTe0[(s2 >> 16) & 0xFF], 8) ^ rotr32(pTe0[(s3 >> 8) & 0xFF], 16) ^ rotr32(pTe0[s0 & 0xFF], 24) ^ RK[4 * unR + 1];
+				S[b][2] = pTe0[s2 >> 24] ^ rotr32(pTe0[(s3 >> 16) & 0xFF], 8) ^ rotr32(pTe0[(s0 >> 8) & 0xFF], 16) ^ rotr32(pTe0[s1 & 0xFF], 24) ^ RK[4 * unR + 2];
+				S[b][3] = pTe0[s3 >> 24] ^ rotr32(pTe0[(s0 >> 16) & 0xFF], 8) ^ rotr32(pTe0[(s1 >> 8) & 0xFF], 16) ^ rotr32(pTe0[s2 & 0xFF], 24) ^ RK[4 * unR + 3];
+			}
+		}
+
+		for (std::size_t b = 0; b < unBlocks; ++b) {
+			const unsigned int s0 = S[b][0], s1 = S[b][1], s2 = S[b][2], s3 = S[b][3];
+
+			S[b][0] = AESSubColumn(s0, s1, s2, s3) ^ RK[4 * unRounds];
+			S[b][1] = AESSubColumn(s1, s2, s3, s0) ^ RK[4 * unRounds + 1];
+			S[b][2] = AESSubColumn(s2, s3, s0, s1) ^ RK[4 * unRounds + 2];
+			S[b][3] = AESSubColumn(s3, s0, s1, s2) ^ RK[4 * unRounds + 3];
+		}
+	}
+
+	class AESKeySchedule {
+	public:
+		constexpr AESKeySchedule() noexcept = default;
+
+		// AES-128 (unKeyBytes == 16) expands the first half of key; the word array is sized for AES-256 either way.
+		constexpr explicit AESKeySchedule(const block32& key, std::size_t unKeyBytes = 32) noexcept : m_unRounds(static_cast<unsigned int>(unKeyBytes / 4 + 6)) {
+			const unsigned int unNk = static_cast<unsigned int>(unKeyBytes / 4);
+
+			for (unsigned int i = 0; i < unNk; ++i) {
+				m_Words[i] = be32(&key[4 * i]);
+			}
+
+			for (unsigned int i = unNk; i < 4 * (m_unRounds + 1); ++i) {
+				unsigned int unT = m_Words[i - 1];
+
+				if (i % unNk == 0) {
+					const unsigned int unRot = (unT << 8) | (unT >> 24);
+					unT = AESSubColumn(unRot, unRot, unRot, unRot) ^ kRCON[i / unNk];
+				} else if ((unNk > 6) && (i % unNk == 4)) {
+					unT = AESSubColumn(unT, unT, unT, unT);
+				}
+
+				m_Words[i] = m_Words[i - unNk] ^ unT;
+			}
+		}
+
+	public:
+		unsigned int m_Words[60] {};
+		unsigned int m_unRounds = 14;
+	};
+
+	// Word-oriented, so constant evaluation runs the same Te0 rounds as the portable runtime path.
+	constexpr block16 AESEncryptBlock(const block16& in, const AESKeySchedule& ks) noexcept {
+		unsigned int S[1][4] {};
+		for (unsigned char c = 0; c < 4; ++c) {
+			S[0][c] = be32(&in[4 * c]) ^ ks.m_Words[c];
+		}
+
+		AESEncryptTable(ks.m_Words, ks.m_unRounds, S);
+
+		block16 out {};
+		for (unsigned char c = 0; c < 4; ++c) {
+			put_be32(&out[4 * c], S[0][c]);
+		}
+
+		return out;
+	}
+
+	constexpr static unsigned long long kGHashLast4[16] = {
+		0x0000, 0x1C20, 0x3840, 0x2460, 0x7080, 0x6CA0, 0x48C0, 0x54E0,
+		0xE100, 0xFD20, 0xD940, 0xC560, 0x9180, 0x8DA0, 0xA9C0, 0xB5E0
+	};
+
+	// Shoup's 4-bit table: m_Hi[i]:m_Lo[i] holds the product of H and the nibble i.
+	class GHashTable {
+	public:
+		constexpr GHashTable() noexcept = default;
+
+		constexpr explicit GHashTable(const block16& H) noexcept {
+			unsigned long long unVH = 0;
+			unsigned long long unVL = 0;
+
+			for (unsigned char i = 0; i < 8; ++i) {
+				unVH = (unVH << 8) | H[i];
+				unVL = (unVL << 8) | H[8 + i];
+			}
+
+			m_Hi[8] = unVH;
+			m_Lo[8] = unVL;
+
+			for (unsigned char i = 4; i > 0; i >>= 1) {
+				const unsigned long long unT = (unVL & 1) * 0xE100000000000000ULL;
+				unVL = (unVH << 63) | (unVL >> 1);
+				unVH = (unVH >> 1) ^ unT;
+
+				m_Hi[i] = unVH;
+				m_Lo[i] = unVL;
+			}
+
+			for (unsigned char i = 2; i <= 8; i *= 2) {
+				for (unsigned char j = 1; j < i; ++j) {
+					m_Hi[i + j] = m_Hi[i] ^ m_Hi[j];
+					m_Lo[i + j] = m_Lo[i] ^ m_Lo[j];
+				}
+			}
+		}
+
+	public:
+		unsigned long long m_Hi[16] {};
+		unsigned long long m_Lo[16] {};
+	};
+
+	template <bool bConstantTime>
+	constexpr void GHashTableShift(const GHashTable& table, unsigned char unNibble, unsigned long long& unZH, unsigned long long& unZL) noexcept {
+		const unsigned char unRem = static_cast<unsigned char>(unZL & 0xF);
+
+		unZL = (unZH << 60) | (unZL >> 4);
+		unZH = unZH >> 4;
+
+		if constexpr (bConstantTime) {
+			unZH ^= ((0ULL - ( unRem       & 1)) & (kGHashLast4[1] << 48)) ^
+					((0ULL - ((unRem >> 1) & 1)) & (kGHashLast4[2] << 48)) ^
+					((0ULL - ((unRem >> 2) & 1)) & (kGHashLast4[4] << 48)) ^
+					((0ULL - ((unRem >> 3) & 1)) & (kGHashLast4[8] << 48));
+
+			for (unsigned char i = 0; i < 16; ++i) {
+				const unsigned long long unMask = 0ULL - static_cast<unsigned long long>((static_cast<unsigned int>(i ^ unNibble) - 1u) >> 31);
+				unZH ^= table.m_Hi[i] & unMask;
+				unZL ^= table.m_Lo[i] & unMask;
+			}
+		} else {
+			unZH ^= kGHashLast4[unRem] << 48;
+			unZH ^= table.m_Hi[unNibble];
+			unZL ^= table.m_Lo[unNibble];
+		}
+	}
+
+	template <bool bConstantTime>
+	constexpr block16 GF128MulTable(const block16& X, const GHashTable& table) noexcept {
+		unsigned long long unZH = 0;
+		unsigned long long unZL = 0;
+
+		for (int i = 15; i >= 0; --i) {
+			const unsigned char unByte = X[static_cast<unsigned char>(i)];
+
+			GHashTableShift<bConstantTime>(table, unByte & 0xF, unZH, unZL);
+			GHashTableShift<bConstantTime>(table, unByte >> 4, unZH, unZL);
+		}
+
+		block16 Z {};
+		for (unsigned char i = 0; i < 8; ++i) {
+			Z[i]     = static_cast<unsigned char>((unZH >> (56 - 8 * i)) & 0xFF);
+			Z[8 + i] = static_cast<unsigned char>((unZL >> (56 - 8 * i)) & 0xFF);
+		}
+
+		return Z;
+	}
+
+	template <bool bConstantTime>
+	constexpr void GHashAccamulateTable(const GHashTable& table, const unsigned char* pData, std::size_t unDataLength, block16& accumulator) noexcept {
+		for (std::size_t unOffset = 0; unOffset < unDataLength; unOffset += 16) {
+			const std::size_t unChunk = (unOffset + 16 <= unDataLength) ? 16 : (unDataLength - unOffset);
+			for (std::size_t i = 0; i < unChunk; ++i) {
+				accumulator[i] ^= pData[unOffset + i];
+			}
+
+			accumulator = GF128MulTable<bConstantTime>(accumulator, table);
+		}
+	}
+
+	template <std::size_t unDataSize>
+	struct GCMResult {
+		std::size_t m_CipherTextSize = unDataSize;
+		unsigned char m_CipherText[unDataSize] {};
+		block16 m_Tag {};
+		constexpr GCMResult() noexcept = default;
+	};
+
+	constexpr void inc32_inplace(block16& ctr) noexcept {
+		for (char i = 15; i >= 12; --i) {
+			if (++ctr[static_cast<unsigned char>(i)] != 0) {
+				break;
+			}
+		}
+	}
+
+	// Compile-time side of every site, so it is written for few constant-evaluation steps: the key schedule is expanded once,
+	// CTR runs on 32-bit words through Te0 and GHASH uses the 4-bit table instead of a bit-serial multiply.
+	template <std::size_t unDataSize, std::size_t unAADSize = 0>
+	constexpr GCMResult<unDataSize> GCMEncrypt(const unsigned char* pPlainText, const unsigned char* pAAD, const block32& key, const iv12& iv, std::size_t unKeyBytes = 32) noexcept {
+		GCMResult<unDataSize> out {};
+
+		const AESKeySchedule ks(key, unKeyBytes);
+		const GHashTable table(AESEncryptBlock(block16 {}, ks));
+
+		block16 J0 {};
+		for (unsigned char i = 0; i < 12; ++i) {
+			J0[i] = iv[i];
+		}
+
+		J0[15] = 1;
+
+		const unsigned int unNonce[3] = { be32(&J0[0]) ^ ks.m_Words[0], be32(&J0[4]) ^ ks.m_Words[1], be32(&J0[8]) ^ ks.m_Words[2] };
+		unsigned int unCounter = 1;
+
+		for (std::size_t unOffset = 0; unOffset < unDataSize; unOffset += 16) {
+			unsigned int S[1][4] = { { unNonce[0], unNonce[1], unNonce[2], ++unCounter ^ ks.m_Words[3] } };
+			AESEncryptTable(ks.m_Words, ks.m_unRounds, S);
+
+			const std::size_t unChunk = (unOffset + 16 <= unDataSize) ? 16 : (unDataSize - unOffset);
+			for (std::size_t i = 0; i < unChunk; ++i) {
+				const unsigned char unKey = static_cast<unsigned char>(S[0][i / 4] >> (24 - 8 * (i % 4)));
+				out.m_CipherText[unOffset + i] = static_cast<unsigned char>(pPlainText[unOffset + i] ^ unKey);
+			}
+		}
+
+		out.m_CipherTextSize = unDataSize;
+
+		block16 S {};
+
+		if constexpr (unAADSize > 0) {
+			GHashAccamulateTable<false>(table, pAAD, unAADSize, S);
+		}
+
+		if constexpr (unDataSize > 0) {
+			GHashAccamulateTable<false>(table, out.m_CipherText, unDataSize, S);
+		}
+
+		const unsigned long long unAADBits = static_cast<unsigned long long>(unAADSize) * 8ull;
+		const unsigned long long unCipherBits = static_cast<unsigned long long>(unDataSize) * 8ull;
+
+		for (unsigned char i = 0; i < 8; ++i) {
+			S[i]     ^= static_cast<unsigned char>((unAADBits    >> (56 - 8 * i)) & 0xFF);
+			S[8 + i] ^= static_cast<unsigned char>((unCipherBits >> (56 - 8 * i)) & 0xFF);
+		}
+
+		S = GF128MulTable<false>(S, table);
+
+		const block16 ENC_J0 = AESEncryptBlock(J0, ks);
+		for (unsigned char i = 0; i < 16; ++i) {
+			out.m_Tag[i] = static_cast<unsigned char>(ENC_J0[i] ^ S[i]);
+		}
+
+		return out;
+	}
+
+	struct AESRoundKeys {
+		constexpr AESRoundKeys() noexcept = default;
+
+		constexpr explicit AESRoundKeys(const AESKeySchedule& ks) noexcept : m_unRounds(static_cast<unsigned char>(ks.m_unRounds)) {
+			for (unsigned char i = 0; i < 60; ++i) {
+				const unsigned int unWord = ks.m_Words[i];
+
+				m_Data[i / 4][4 * (i % 4)]     = static_cast<unsigned char>((unWord >> 24) & 0xFF);
+				m_Data[i / 4][4 * (i % 4) + 1] = static_cast<unsigned char>((unWord >> 16) & 0xFF);
+				m_Data[i / 4][4 * (i % 4) + 2] = static_cast<unsigned char>((unWord >>  8) & 0xFF);
+				m_Data[i / 4][4 * (i % 4) + 3] = static_cast<unsigned char>( unWord        & 0xFF);
+			}
+		}
+
+		alignas(16) unsigned char m_Data[15][16] {};
+		unsigned char m_unRounds = 14;
+	};
+
+	// Everything GCMDecrypt derives from the key before touching the ciphertext: round keys, H = E(K, 0^128) and E(K, J0).
+	// The stored form also carries the round count, so a loaded AES-128 schedule runs 10 rounds.
+	struct GCMPrecomputed {
+		static constexpr std::size_t kSize = sizeof(AESRoundKeys::m_Data) + 33;
+
+		constexpr GCMPrecomputed() noexcept = default;
+
+		constexpr GCMPrecomputed(const block32& key, const iv12& iv, std::size_t unKeyBytes = 32) noexcept {
+			const AESKeySchedule ks(key, unKeyBytes);
+			m_RoundKeys = AESRoundKeys(ks);
+
+			block16 J0 {};
+			for (unsigned char i = 0; i < 12; ++i) {
+				J0[i] = iv[i];
+			}
+
+			J0[15] = 1;
+
+			m_H = AESEncryptBlock(block16 {}, ks);
+			m_EncJ0 = AESEncryptBlock(J0, ks);
+		}
+
+		template<std::size_t unMaskSize>
+		constexpr void Store(unsigned char* pOut, const Bytes<unMaskSize>& mask) const noexcept {
+			for (std::size_t i = 0; i < kSize; ++i) {
+				pOut[i] = static_cast<unsigned char>(Get(i) ^ mask[i % unMaskSize]);
+			}
+		}
+
+		template<std::size_t unMaskSize>
+		constexpr void Load(const unsigned char* pIn, const Bytes<unMaskSize>& mask) noexcept {
+			for (std::size_t i = 0; i < kSize; ++i) {
+				Get(i) = static_cast<unsigned char>(pIn[i] ^ mask[i % unMaskSize]);
+			}
+		}
+
+	private:
+		constexpr unsigned char& Get(std::size_t unIndex) noexcept {
+			if (unIndex < sizeof(m_RoundKeys.m_Data)) {
+				return m_RoundKeys.m_Data[unIndex / 16][unIndex % 16];
+			}
+
+			unIndex -= sizeof(m_RoundKeys.m_Data);
+			if (unIndex == 32) {
+				return m_RoundKeys.m_unRounds;
+			}
+
+			return (unIndex < 16) ? m_H[unIndex] : m_EncJ0[unIndex - 16];
+		}
+
+		constexpr unsigned char Get(std::size_t unIndex) const noexcept {
+			if (unIndex < sizeof(m_RoundKeys.m_Data)) {
+				return m_RoundKeys.m_Data[unIndex / 16][unIndex % 16];
+			}
+
+			unIndex -= sizeof(m_RoundKeys.m_Data);
+			if (unIndex == 32) {
+				return m_RoundKeys.m_unRounds;
+			}
+
+			return (unIndex < 16) ? m_H[unIndex] : m_EncJ0[unIndex - 16];
+		}
+
+	public:
+		AESRoundKeys m_RoundKeys {};
+		block16 m_H {};
+		block16 m_EncJ0 {};
+	};
+
+	inline void SecureWipe(void* pData, std::size_t unSize) noexcept {
+		volatile unsigned char* p = static_cast<volatile unsigned char*>(pData);
+		for (std::size_t i = 0; i < unSize; ++i) {
+			p[i] = 0;
+		}
+	}
+
+	inline void AESECBPortable(const AESRoundKeys& rk, block16* pBlocks, std::size_t unCount) noexcept {
+		unsigned int RK[60] {};
+		for (unsigned char i = 0; i < 60; ++i) {
+			RK[i] = be32(&rk.m_Data[i / 4][4 * (i % 4)]);
+		}
+
+		for (std::size_t i = 0; i < unCount; ++i) {
+			unsigned int S[1][4] {};
+			for (unsigned char c = 0; c < 4; ++c) {
+				S[0][c] = be32(&pBlocks[i][4 * c]) ^ RK[c];
+			}
+
+			AESEncryptTable(RK, rk.m_unRounds, S);
+
+			for (unsigned char c = 0; c < 4; ++c) {
+				put_be32(&pBlocks[i][4 * c], S[0][c]);
+			}
+		}
+
+		SecureWipe(RK, sizeof(RK));
+	}
+
+	// Four counter blocks go through each round together so their table lookups overlap.
+	inline void AESCTRPortable(const AESRoundKeys& rk, const block16& J0, const unsigned char* pIn, std::size_t unSize, unsigned char* pOut) noexcept {
+		unsigned int RK[60] {};
+		for (unsigned char i = 0; i < 60; ++i) {
+			RK[i] = be32(&rk.m_Data[i / 4][4 * (i % 4)]);
+		}
+
+		const unsigned int unNonce[3] = { be32(&J0[0]) ^ RK[0], be32(&J0[4]) ^ RK[1], be32(&J0[8]) ^ RK[2] };
+		unsigned int unCounter = be32(&J0[12]);
+
+		unsigned char keystream[64] {};
+
+		for (std::size_t unOffset = 0; unOffset < unSize; unOffset += 64) {
+			unsigned int S[4][4] {};
+			for (unsigned char b = 0; b < 4; ++b) {
+				S[b][0] = unNonce[0];
+				S[b][1] = unNonce[1];
+				S[b][2] = unNonce[2];
+				S[b][3] = (unCounter + 1 + b) ^ RK[3];
+			}
+
+			unCounter += 4;
+
+			AESEncryptTable(RK, rk.m_unRounds, S);
+
+			for (unsigned char b = 0; b < 4; ++b) {
+				for (unsigned char c = 0; c < 4; ++c) {
+					put_be32(&keystream[16 * b + 4 * c], S[b][c]);
+				}
+			}
+
+			const std::size_t unChunk = (unOffset + 64 <= unSize) ? 64 : (unSize - unOffset);
+			for (std::size_t i = 0; i < unChunk; ++i) {
+				pOut[unOffset + i] = static_cast<unsigned char>(pIn[unOffset + i] ^ keystream[i]);
+			}
+		}
+
+		SecureWipe(RK, sizeof(RK));
+		SecureWipe(keystream, sizeof(keystream));
+	}
+
+	// Bitsliced AES: eight 64-bit words hold four blocks, word i carrying bit i of every byte, so SubBytes is a Boolean
+	// circuit and no lookup depends on secret data. Two states are kept in flight, i.e. eight blocks per call.
+	constexpr unsigned int le32(const unsigned char* pBuffer) noexcept {
+		return  static_cast<unsigned int>(pBuffer[0])        |
+			   (static_cast<unsigned int>(pBuffer[1]) <<  8) |
+			   (static_cast<unsigned int>(pBuffer[2]) << 16) |
+			   (static_cast<unsigned int>(pBuffer[3]) << 24);
+	}
+
+	constexpr void put_le32(unsigned char* pBuffer, unsigned int unX) noexcept {
+		pBuffer[0] = static_cast<unsigned char>( unX        & 0xFF);
+		pBuffer[1] = static_cast<unsigned char>((unX >>  8) & 0xFF);
+		pBuffer[2] = static_cast<unsigned char>((unX >> 16) & 0xFF);
+		pBuffer[3] = static_cast<unsigned char>((unX >> 24) & 0xFF);
+	}
+
+	template<unsigned int unShift>
+	inline void BitsliceSwap(unsigned long long unLow, unsigned long long& unX, unsigned long long& unY) noexcept {
+		const unsigned long long unA = unX;
+		const unsigned long long unB = unY;
+
+		unX = (unA & unLow) | ((unB & unLow) << unShift);
+		unY = ((unA & ~unLow) >> unShift) | (unB & ~unLow);
+	}
+
+	// Transposes between byte order and bitsliced order; the transform is its own inverse.
+	inline void BitsliceOrtho(unsigned long long Q[8]) noexcept {
+		for (unsigned char i = 0; i < 8; i += 2) {
+			BitsliceSwap<1>(0x5555555555555555ull, Q[i], Q[i + 1]);
+		}
+
+		for (unsigned char i = 0; i < 8; i += 4) {
+			BitsliceSwap<2>(0x3333333333333333ull, Q[i], Q[i + 2]);
+			BitsliceSwap<2>(0x3333333333333333ull, Q[i + 1], Q[i + 3]);
+		}
+
+		for (unsigned char i = 0; i < 4; ++i) {
+			BitsliceSwap<4>(0x0F0F0F0F0F0F0F0Full, Q[i], Q[i + 4]);
+		}
+	}
+
+	// Spreads the four little-endian words of one block over two state words, leaving room for the other three blocks.
+	inline void BitsliceLoad(const unsigned char* pBlock, unsigned long long& unQ0, unsigned long long& unQ1) noexcept {
+		unsigned long long X[4] {};
+		for (unsigned char i = 0; i < 4; ++i) {
+			X[i] = le32(pBlock + 4 * i);
+			X[i] = (X[i] | (X[i] << 16)) & 0x0000FFFF0000FFFFull;
+			X[i] = (X[i] | (X[i] <<  8)) & 0x00FF00FF00FF00FFull;
+		}
+
+		unQ0 = X[0] | (X[2] << 8);
+		unQ1 = X[1] | (X[3] << 8);
+	}
+
+	inline void BitsliceStore(unsigned char* pBlock, unsigned long long unQ0, unsigned long long unQ1) noexcept {
+		unsigned long long X[4] { unQ0 & 0x00FF00FF00FF00FFull, unQ1 & 0x00FF00FF00FF00FFull, (unQ0 >> 8) & 0x00FF00FF00FF00FFull, (unQ1 >> 8) & 0x00FF00FF00FF00FFull };
+		for (unsigned char i = 0; i < 4; ++i) {
+			X[i] = (X[i] | (X[i] >> 8)) & 0x0000FFFF0000FFFFull;
+			put_le32(pBlock + 4 * i, static_cast<unsigned int>(X[i] | (X[i] >> 16)));
+		}
+	}
+
+	// Boyar-Peralta S-box circuit (113 gates).
+	inline void BitsliceSubBytes(unsigned long long Q[8]) noexcept {
+		const unsigned long long x0 = Q[7], x1 = Q[6], x2 = Q[5], x3 = Q[4], x4 = Q[3], x5 = Q[2], x6 = Q[1], x7 = Q[0];
+
+		const unsigned long long y14 = x3 ^ x5;
+		const unsigned long long y13 = x0 ^ x6;
+		const unsigned long long y9 = x0 ^ x3;
+		const unsigned long long y8 = x0 ^ x5;
+		const unsigned long long t0 = x1 ^ x2;
+		const unsigned long long y1 = t0 ^ x7;
+		const unsigned long long y4 = y1 ^ x3;
+		const unsigned long long y12 = y13 ^ y14;
+		const unsigned long long y2 = y1 ^ x0;
+		const unsigned long long y5 = y1 ^ x6;
+		const unsigned long long y3 = y5 ^ y8;
+		const unsigned long long t1 = x4 ^ y12;
+		const unsigned long long y15 = t1 ^ x5;
+		const unsigned long long y20 = t1 ^ x1;
+		const unsigned long long y6 = y15 ^ x7;
+		const unsigned long long y10 = y15 ^ t0;
+		const unsigned long long y11 = y20 ^ y9;
+		const unsigned long long y7 = x7 ^ y11;
+		const unsigned long long y17 = y10 ^ y11;
+		const unsigned long long y19 = y10 ^ y8;
+		const unsigned long long y16 = t0 ^ y11;
+		const unsigned long long y21 = y13 ^ y16;
+		const unsigned long long y18 = x0 ^ y16;
+
+		const unsigned long long t2 = y12 & y15;
+		const unsigned long long t3 = y3 & y6;
+		const unsigned long long t4 = t3 ^ t2;
+		const unsigned long long t5 = y4 & x7;
+		const unsigned long long t6 = t5 ^ t2;
+		const unsigned long long t7 = y13 & y16;
+		const unsigned long long t8 = y5 & y1;
+		const unsigned long long t9 = t8 ^ t7;
+		const unsigned long long t10 = y2 & y7;
+		const unsigned long long t11 = t10 ^ t7;
+		const unsigned long long t12 = y9 & y11;
+		const unsigned long long t13 = y14 & y17;
+		const unsigned long long t14 = t13 ^ t12;
+		const unsigned long long t15 = y8 & y10;
+		const unsigned long long t16 = t15 ^ t12;
+		const unsigned long long t17 = t4 ^ t14;
+		const unsigned long long t18 = t6 ^ t16;
+		const unsigned long long t19 = t9 ^ t14;
+		const unsigned long long t20 = t11 ^ t16;
+		const unsigned long long t21 = t17 ^ y20;
+		const unsigned long long t22 = t18 ^ y19;
+		const unsigned long long t23 = t19 ^ y21;
+		const unsigned long long t24 = t20 ^ y18;
+
+		const unsigned long long t25 = t21 ^ t22;
+		const unsigned long long t26 = t21 & t23;
+		const unsigned long long t27 = t24 ^ t26;
+		const unsigned long long t28 = t25 & t27;
+		const unsigned long long t29 = t28 ^ t22;
+		const unsigned long long t30 = t23 ^ t24;
+		const unsigned long long t31 = t22 ^ t26;
+		const unsigned long long t32 = t31 & t30;
+		const unsigned long long t33 = t32 ^ t24;
+		const unsigned long long t34 = t23 ^ t33;
+		const unsigned long long t35 = t27 ^ t33;
+		const unsigned long long t36 = t24 & t35;
+		const unsigned long long t37 = t36 ^ t34;
+		const unsigned long long t38 = t27 ^ t36;
+		const unsigned long long t39 = t29 & t38;
+		const unsigned long long t40 = t25 ^ t39;
+
+		const unsigned long long t41 = t40 ^ t37;
+		const unsigned long long t42 = t29 ^ t33;
+		const unsigned long long t43 = t29 ^ t40;
+		const unsigned long long t44 = t33 ^ t37;
+		const unsigned long long t45 = t42 ^ t41;
+		const unsigned long long z0 = t44 & y15;
+		const unsigned long long z1 = t37 & y6;
+		const unsigned long long z2 = t33 & x7;
+		const unsigned long long z3 = t43 & y16;
+		const unsigned long long z4 = t40 & y1;
+		const unsigned long long z5 = t29 & y7;
+		const unsigned long long z6 = t42 & y11;
+		const unsigned long long z7 = t45 & y17;
+		const unsigned long long z8 = t41 & y10;
+		const unsigned long long z9 = t44 & y12;
+		const unsigned long long z10 = t37 & y3;
+		const unsigned long long z11 = t33 & y4;
+		const unsigned long long z12 = t43 & y13;
+		const unsigned long long z13 = t40 & y5;
+		const unsigned long long z14 = t29 & y2;
+		const unsigned long long z15 = t42 & y9;
+		const unsigned long long z16 = t45 & y14;
+		const unsigned long long z17 = t41 & y8;
+
+		const unsigned long long t46 = z15 ^ z16;
+		const unsigned long long t47 = z10 ^ z11;
+		const unsigned long long t48 = z5 ^ z13;
+		const unsigned long long t49 = z9 ^ z10;
+		const unsigned long long t50 = z2 ^ z12;
+		const unsigned long long t51 = z2 ^ z5;
+		const unsigned long long t52 = z7 ^ z8;
+		const unsigned long long t53 = z0 ^ z3;
+		const unsigned long long t54 = z6 ^ z7;
+		const unsigned long long t55 = z16 ^ z17;
+		const unsigned long long t56 = z12 ^ t48;
+		const unsigned long long t57 = t50 ^ t53;
+		const unsigned long long t58 = z4 ^ t46;
+		const unsigned long long t59 = z3 ^ t54;
+		const unsigned long long t60 = t46 ^ t57;
+		const unsigned long long t61 = z14 ^ t57;
+		const unsigned long long t62 = t52 ^ t58;
+		const unsigned long long t63 = t49 ^ t58;
+		const unsigned long long t64 = z4 ^ t59;
+		const unsigned long long t65 = t61 ^ t62;
+		const unsigned long long t66 = z1 ^ t63;
+		const unsigned long long t67 = t64 ^ t65;
+
+		const unsigned long long s3 = t53 ^ t66;
+
+		Q[7] = t59 ^ t63;
+		Q[6] = t64 ^ ~s3;
+		Q[5] = t55 ^ ~t67;
+		Q[4] = s3;
+		Q[3] = t51 ^ t66;
+		Q[2] = t47 ^ t65;
+		Q[1] = t56 ^ ~t62;
+		Q[0] = t48 ^ ~t60;
+	}
+
+	inline void BitsliceShiftRows(unsigned long long Q[8]) noexcept {
+		for (unsigned char i = 0; i < 8; ++i) {
+			const unsigned long long unX = Q[i];
+
+			Q[i] =  (unX & 0x000000000000FFFFull)         |
+				   ((unX & 0x00000000FFF00000ull) >>  4) |
+				   ((unX & 0x00000000000F0000ull) << 12) |
+				   ((unX & 0x0000FF0000000000ull) >>  8) |
+				   ((unX & 0x000000FF00000000ull) <<  8) |
+				   ((unX & 0xF000000000000000ull) >> 12) |
+				   ((unX & 0x0FFF000000000000ull) <<  4);
+		}
+	}
+
+	constexpr unsigned long long BitsliceRotate32(unsigned long long unX) noexcept {
+		return (unX << 32) | (unX >> 32);
+	}
+
+	inline void BitsliceMixColumns(unsigned long long Q[8]) noexcept {
+		unsigned long long R[8] {};
+		for (unsigned char i = 0; i < 8; ++i) {
+			R[i] = (Q[i] >> 16) | (Q[i] << 48);
+		}
+
+		const unsigned long long unQ7R7 = Q[7] ^ R[7];
+
+		const unsigned long long unQ0 = Q[0], unQ1 = Q[1], unQ2 = Q[2], unQ3 = Q[3], unQ4 = Q[4], unQ5 = Q[5], unQ6 = Q[6];
+
+		Q[0] = unQ7R7 ^ R[0] ^ BitsliceRotate32(unQ0 ^ R[0]);
+		Q[1] = unQ0 ^ R[0] ^ unQ7R7 ^ R[1] ^ BitsliceRotate32(unQ1 ^ R[1]);
+		Q[2] = unQ1 ^ R[1] ^ R[2] ^ BitsliceRotate32(unQ2 ^ R[2]);
+		Q[3] = unQ2 ^ R[2] ^ unQ7R7 ^ R[3] ^ BitsliceRotate32(unQ3 ^ R[3]);
+		Q[4] = unQ3 ^ R[3] ^ unQ7R7 ^ R[4] ^ BitsliceRotate32(unQ4 ^ R[4]);
+		Q[5] = unQ4 ^ R[4] ^ R[5] ^ BitsliceRotate32(unQ5 ^ R[5]);
+		Q[6] = unQ5 ^ R[5] ^ R[6] ^ BitsliceRotate32(unQ6 ^ R[6]);
+		Q[7] = unQ6 ^ R[6] ^ R[7] ^ BitsliceRotate32(unQ7R7);
+	}
+
+	// Round keys in bitsliced form: each one is replicated into all four lanes and transposed like a state.
+	struct AESBitslicedKeys {
+		explicit AESBitslicedKeys(const AESRoundKeys& rk) noexcept : m_unRounds(rk.m_unRounds) {
+			for (unsigned char unR = 0; unR < 15; ++unR) {
+				unsigned long long* Q = &m_Data[8 * unR];
+				for (unsigned char i = 0; i < 4; ++i) {
+					BitsliceLoad(rk.m_Data[unR], Q[i], Q[i + 4]);
+				}
+
+				BitsliceOrtho(Q);
+			}
+		}
+
+		AESBitslicedKeys(const AESBitslicedKeys&) = delete;
+		AESBitslicedKeys& operator=(const AESBitslicedKeys&) = delete;
+
+		~AESBitslicedKeys() noexcept {
+			SecureWipe(m_Data, sizeof(m_Data));
+		}
+
+		unsigned long long m_Data[8 * 15] {};
+		unsigned int m_unRounds = 14;
+	};
+
+	// Encrypts 4 * unStates blocks in place; the states go through each step together so their work overlaps.
+	template<std::size_t unStates>
+	inline void AESEncryptBitsliced(const AESBitslicedKeys& sk, unsigned char(&blocks)[unStates * 64]) noexcept {
+		unsigned long long Q[unStates][8] {};
+		for (std::size_t s = 0; s < unStates; ++s) {
+			for (unsigned char i = 0; i < 4; ++i) {
+				BitsliceLoad(&blocks[64 * s + 16 * i], Q[s][i], Q[s][i + 4]);
+			}
+
+			BitsliceOrtho(Q[s]);
+
+			for (unsigned char i = 0; i < 8; ++i) {
+				Q[s][i] ^= sk.m_Data[i];
+			}
+		}
+
+		for (unsigned int unR = 1; unR <= sk.m_unRounds; ++unR) {
+			for (std::size_t s = 0; s < unStates; ++s) {
+				BitsliceSubBytes(Q[s]);
+				BitsliceShiftRows(Q[s]);
+
+				if (unR != sk.m_unRounds) {
+					BitsliceMixColumns(Q[s]);
+				}
+
+				for (unsigned char i = 0; i < 8; ++i) {
+					Q[s][i] ^= sk.m_Data[8 * unR + i];
+				}
+			}
+		}
+
+		for (std::size_t s = 0; s < unStates; ++s) {
+			BitsliceOrtho(Q[s]);
+
+			for (unsigned char i = 0; i < 4; ++i) {
+				BitsliceStore(&blocks[64 * s + 16 * i], Q[s][i], Q[s][i + 4]);
+			}
+		}
+
+		SecureWipe(Q, sizeof(Q));
+	}
+
+	inline void AESECBBitsliced(const AESRoundKeys& rk, block16* pBlocks, std::size_t unCount) noexcept {
+		const AESBitslicedKeys sk(rk);
+
+		unsigned char blocks[64] {};
+		for (std::size_t unOffset = 0; unOffset < unCount; unOffset += 4) {
+			const std::size_t unChunk = (unOffset + 4 <= unCount) ? 4 : (unCount - unOffset);
+			for (std::size_t b = 0; b < unChunk; ++b) {
+				for (unsigned char i = 0; i < 16; ++i) {
+					blocks[16 * b + i] = pBlocks[unOffset + b][i];
+				}
+			}
+
+			AESEncryptBitsliced<1>(sk, blocks);
+
+			for (std::size_t b = 0; b < unChunk; ++b) {
+				for (unsigned char i = 0; i < 16; ++i) {
+					pBlocks[unOffset + b][i] = blocks[16 * b + i];
+				}
+			}
+		}
+
+		SecureWipe(blocks, sizeof(blocks));
+	}
+
+	inline void AESCTRBitsliced(const AESRoundKeys& rk, const block16& J0, const unsigned char* pIn, std::size_t unSize, unsigned char* pOut) noexcept {
+		const AESBitslicedKeys sk(rk);
+
+		unsigned int unCounter = be32(&J0[12]);
+
+		unsigned char keystream[128] {};
+		for (std::size_t unOffset = 0; unOffset < unSize; unOffset += 128) {
+			for (unsigned char b = 0; b < 8; ++b) {
+				for (unsigned char i = 0; i < 12; ++i) {
+					keystream[16 * b + i] = J0[i];
+				}
+
+				put_be32(&keystream[16 * b + 12], unCounter + 1 + b);
+			}
+
+			unCounter += 8;
+
+			AESEncryptBitsliced<2>(sk, keystream);
+
+			const std::size_t unChunk = (unOffset + 128 <= unSize) ? 128 : (unSize - unOffset);
+			for (std::size_t i = 0; i < unChunk; ++i) {
+				pOut[unOffset + i] = static_cast<unsigned char>(pIn[unOffset + i] ^ keystream[i]);
+			}
+		}
+
+		SecureWipe(keystream, sizeof(keystream));
+	}
+
+#ifdef _CRYPTOAES_X86
+	struct CPUFeatures {
+		bool m_bSSE2 = false;
+		bool m_bSSSE3 = false;
+		bool m_bAESNI = false;
+		bool m_bPCLMUL = false;
+		bool m_bAVX2 = false;
+		bool m_bVAES = false;
+	};
+
+	inline const CPUFeatures& GetCPUFeatures() noexcept {
+		static const CPUFeatures features = []() -> CPUFeatures {
+			CPUFeatures result {};
+
+			unsigned int unECX = 0;
+			unsigned int unEDX = 0;
+			unsigned int unEBX7 = 0;
+			unsigned int unECX7 = 0;
+			unsigned long long unXCR0 = 0;
+#if defined(_MSC_VER)
+			int nRegs[4] {};
+			__cpuid(nRegs, 0);
+			const int nMaxLeaf = nRegs[0];
+
+			__cpuid(nRegs, 1);
+			unECX = static_cast<unsigned int>(nRegs[2]);
+			unEDX = static_cast<unsigned int>(nRegs[3]);
+
+			if (nMaxLeaf >= 7) {
+				__cpuidex(nRegs, 7, 0);
+				unEBX7 = static_cast<unsigned int>(nRegs[1]);
+				unECX7 = static_cast<unsigned int>(nRegs[2]);
+			}
+
+			if ((unECX >> 27) & 1) {
+				unXCR0 = _xgetbv(0);
+			}
+#else
+			unsigned int unEAX = 0, unEBX = 0, unEDX7 = 0;
+			if (!__get_cpuid(1, &unEAX, &unEBX, &unECX, &unEDX)) {
+				return result;
+			}
+
+			if (!__get_cpuid_count(7, 0, &unEAX, &unEBX7, &unECX7, &unEDX7)) {
+				unEBX7 = unECX7 = 0;
+			}
+
+			if ((unECX >> 27) & 1) {
+				unsigned int unXCR0Lo = 0, unXCR0Hi = 0;
+				__asm__ volatile("xgetbv" : "=a"(unXCR0Lo), "=d"(unXCR0Hi) : "c"(0));
+				unXCR0 = (static_cast<unsigned long long>(unXCR0Hi) << 32) | unXCR0Lo;
+			}
+#endif
+			const bool bOSAVX = ((unECX >> 28) & 1) && ((unXCR0 & 0x6) == 0x6); // AVX + OSXSAVE with XMM/YMM state enabled
+
+			result.m_bSSE2   = ((unEDX >> 26) & 1) != 0;
+			result.m_bSSSE3  = ((unECX >>  9) & 1) != 0;
+			result.m_bAESNI  = ((unECX >> 25) & 1) != 0;
+			result.m_bPCLMUL = ((unECX >>  1) & 1) != 0;
+			result.m_bAVX2   = bOSAVX && (((unEBX7 >> 5) & 1) != 0);
+			result.m_bVAES   = result.m_bAVX2 && result.m_bAESNI && (((unECX7 >> 9) & 1) != 0);
+
+			return result;
+		}();
+
+		return features;
+	}
+
+	_CRYPTOAES_TARGET("aes,sse2") inline __m128i AESEncryptBlockAESNI(__m128i block, const __m128i RK[15], unsigned int unRounds) noexcept {
+		block = _mm_xor_si128(block, RK[0]);
+
+		for (unsigned int unR = 1; unR < unRounds; ++unR) {
+			block = _mm_aesenc_si128(block, RK[unR]);
+		}
+
+		return _mm_aesenclast_si128(block, RK[unRounds]);
+	}
+
+	_CRYPTOAES_TARGET("aes,sse2") inline void AESECBAESNI(const AESRoundKeys& rk, block16* pBlocks, std::size_t unCount) noexcept {
+		__m128i RK[15];
+		for (unsigned char i = 0; i < 15; ++i) {
+			RK[i] = _mm_load_si128(reinterpret_cast<const __m128i*>(rk.m_Data[i]));
+		}
+
+		for (std::size_t i = 0; i < unCount; ++i) {
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pBlocks[i].data()), AESEncryptBlockAESNI(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pBlocks[i].data())), RK, rk.m_unRounds));
+		}
+
+		SecureWipe(RK, sizeof(RK));
+	}
+
+	_CRYPTOAES_TARGET("aes,sse2") inline __m128i MakeCounterBlock(__m128i nonce, unsigned int unCounter) noexcept {
+		const unsigned int unBE = (unCounter >> 24) | ((unCounter >> 8) & 0xFF00) | ((unCounter << 8) & 0xFF0000) | (unCounter << 24);
+		return _mm_or_si128(nonce, _mm_slli_si128(_mm_cvtsi32_si128(static_cast<int>(unBE)), 12));
+	}
+
+	// Eight counter blocks are kept in flight so AESENC latency is hidden behind independent work.
+	_CRYPTOAES_TARGET("aes,sse2") inline void AESCTRAESNI(const AESRoundKeys& rk, const block16& J0, const unsigned char* pIn, std::size_t unSize, unsigned char* pOut) noexcept {
+		__m128i RK[15];
+		for (unsigned char i = 0; i < 15; ++i) {
+			RK[i] = _mm_load_si128(reinterpret_cast<const __m128i*>(rk.m_Data[i]));
+		}
+
+		const __m128i nonce = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(J0.data())), _mm_set_epi32(0, -1, -1, -1));
+		unsigned int unCounter = be32(&J0[12]);
+
+		std::size_t unOffset = 0;
+		for (; unOffset + 128 <= unSize; unOffset += 128) {
+			__m128i B[8];
+			for (unsigned char i = 0; i < 8; ++i) {
+				B[i] = _mm_xor_si128(MakeCounterBlock(nonce, unCounter + 1 + i), RK[0]);
+			}
+
+			unCounter += 8;
+
+			for (unsigned int unR = 1; unR < rk.m_unRounds; ++unR) {
+				for (unsigned char i = 0; i < 8; ++i) {
+					B[i] = _mm_aesenc_si128(B[i], RK[unR]);
+				}
+			}
+
+			for (unsigned char i = 0; i < 8; ++i) {
+				B[i] = _mm_aesenclast_si128(B[i], RK[rk.m_unRounds]);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(pOut + unOffset + 16 * i), _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pIn + unOffset + 16 * i)), B[i]));
+			}
+		}
+
+		for (; unOffset + 16 <= unSize; unOffset += 16) {
+			const __m128i keystream = AESEncryptBlockAESNI(MakeCounterBlock(nonce, ++unCounter), RK, rk.m_unRounds);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pOut + unOffset), _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pIn + unOffset)), keystream));
+		}
+
+		if (unOffset < unSize) {
+			block16 keystream {};
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(keystream.data()), AESEncryptBlockAESNI(MakeCounterBlock(nonce, ++unCounter), RK, rk.m_unRounds));
+
+			for (std::size_t i = 0; unOffset + i < unSize; ++i) {
+				pOut[unOffset + i] = static_cast<unsigned char>(pIn[unOffset + i] ^ keystream[i]);
+			}
+
+			SecureWipe(&keystream, sizeof(keystream));
+		}
+
+		SecureWipe(RK, sizeof(RK));
+	}
+
+	// VAES runs two counter blocks per 256-bit AESENC; four registers give the same eight blocks in flight as the AES-NI path.
+	_CRYPTOAES_TARGET("vaes,avx2,aes") inline void AESCTRVAES(const AESRoundKeys& rk, const block16& J0, const unsigned char* pIn, std::size_t unSize, unsigned char* pOut) noexcept {
+		__m256i RK[15];
+		for (unsigned char i = 0; i < 15; ++i) {
+			RK[i] = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(rk.m_Data[i])));
+		}
+
+		const __m128i nonce = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(J0.data())), _mm_set_epi32(0, -1, -1, -1));
+		unsigned int unCounter = be32(&J0[12]);
+
+		std::size_t unOffset = 0;
+		for (; unOffset + 128 <= unSize; unOffset += 128) {
+			__m256i B[4];
+			for (unsigned char i = 0; i < 4; ++i) {
+				const __m128i lo = MakeCounterBlock(nonce, unCounter + 1 + 2 * i);
+				const __m128i hi = MakeCounterBlock(nonce, unCounter + 2 + 2 * i);
+				B[i] = _mm256_xor_si256(_mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1), RK[0]);
+			}
+
+			unCounter += 8;
+
+			for (unsigned int unR = 1; unR < rk.m_unRounds; ++unR) {
+				for (unsigned char i = 0; i < 4; ++i) {
+					B[i] = _mm256_aesenc_epi128(B[i], RK[unR]);
+				}
+			}
+
+			for (unsigned char i = 0; i < 4; ++i) {
+				B[i] = _mm256_aesenclast_epi128(B[i], RK[rk.m_unRounds]);
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(pOut + unOffset + 32 * i), _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(pIn + unOffset + 32 * i)), B[i]));
+			}
+		}
+
+		if (unOffset < unSize) {
+			block16 ctr = J0;
+			put_be32(&ctr[12], unCounter);
+
+			AESCTRAESNI(rk, ctr, pIn + unOffset, unSize - unOffset, pOut + unOffset);
+		}
+
+		SecureWipe(RK, sizeof(RK));
+	}
+#endif
+
+	// AES implementations the runtime dispatch chooses from. Auto picks the fastest one the CPU and build allow; the others
+	// can only be forced in builds that define CRYPTOAES_SELECTABLE_BACKEND (benchmarks, cross-checks).
+	enum class Backend : unsigned char {
+		Auto,
+		VAES,      // AVX2 + VAES for CTR, AES-NI + PCLMULQDQ otherwise
+		AESNI,     // AES-NI + PCLMULQDQ
+		Table,     // Portable T-table AES, software GHASH
+		Bitsliced  // Portable bitsliced AES, software GHASH
+	};
+
+#ifdef CRYPTOAES_SELECTABLE_BACKEND
+	inline std::atomic<Backend> g_eBackend { Backend::Auto };
+
+	inline Backend GetBackend() noexcept { return g_eBackend.load(std::memory_order_relaxed); }
+
+	// Not synchronized with decrypts in flight: switch backends between runs.
+	inline void SetBackend(Backend eBackend) noexcept { g_eBackend.store(eBackend, std::memory_order_relaxed); }
+#else
+	constexpr Backend GetBackend() noexcept { return Backend::Auto; }
+#endif
+
+#ifdef _CRYPTOAES_X86
+	inline bool UseVAES() noexcept {
+		const Backend eBackend = GetBackend();
+		return ((eBackend == Backend::Auto) || (eBackend == Backend::VAES)) && GetCPUFeatures().m_bVAES;
+	}
+
+	inline bool UseAESNI() noexcept {
+		const Backend eBackend = GetBackend();
+		return ((eBackend == Backend::Auto) || (eBackend == Backend::VAES) || (eBackend == Backend::AESNI)) && GetCPUFeatures().m_bAESNI;
+	}
+
+	inline bool UsePCLMUL() noexcept {
+		const Backend eBackend = GetBackend();
+		return ((eBackend == Backend::Auto) || (eBackend == Backend::VAES) || (eBackend == Backend::AESNI)) && GetCPUFeatures().m_bPCLMUL && GetCPUFeatures().m_bSSSE3;
+	}
+#endif
+
+	inline bool UseTableAES() noexcept {
+		switch (GetBackend()) {
+			case Backend::Table:
+				return true;
+			case Backend::Bitsliced:
+				return false;
+			default:
+#ifdef CRYPTOAES_TABLE_AES
+				return true;
+#else
+				return false;
+#endif
+		}
+	}
+
+	// Whether SetBackend(eBackend) would actually run that backend on this CPU and build.
+	inline bool IsBackendAvailable(Backend eBackend) noexcept {
+		switch (eBackend) {
+			case Backend::Auto:
+			case Backend::Table:
+			case Backend::Bitsliced:
+				return true;
+#ifdef _CRYPTOAES_X86
+			case Backend::VAES:
+				return GetCPUFeatures().m_bVAES && GetCPUFeatures().m_bPCLMUL && GetCPUFeatures().m_bSSSE3;
+			case Backend::AESNI:
+				return GetCPUFeatures().m_bAESNI && GetCPUFeatures().m_bPCLMUL && GetCPUFeatures().m_bSSSE3;
+#endif
+			default:
+				return false;
+		}
+	}
+
+	inline void AESECB(const AESRoundKeys& rk, block16* pBlocks, std::size_t unCount) noexcept {
+#ifdef _CRYPTOAES_X86
+		if (UseAESNI()) {
+			AESECBAESNI(rk, pBlocks, unCount);
+			return;
+		}
+#endif
+
+		if (UseTableAES()) {
+			AESECBPortable(rk, pBlocks, unCount);
+		} else {
+			AESECBBitsliced(rk, pBlocks, unCount);
+		}
+	}
+
+	inline void AESCTR(const AESRoundKeys& rk, const block16& J0, const unsigned char* pIn, std::size_t unSize, unsigned char* pOut) noexcept {
+#ifdef _CRYPTOAES_X86
+		if ((unSize >= 128) && UseVAES()) {
+			AESCTRVAES(rk, J0, pIn, unSize, pOut);
+			return;
+		}
+
+		if (UseAESNI()) {
+			AESCTRAESNI(rk, J0, pIn, unSize, pOut);
+			return;
+		}
+#endif
+
+		if (UseTableAES()) {
+			AESCTRPortable(rk, J0, pIn, unSize, pOut);
+		} else {
+			AESCTRBitsliced(rk, J0, pIn, unSize, pOut);
+		}
+	}
+
+#ifdef _CRYPTOAES_X86
+	_CRYPTOAES_TARGET("pclmul,sse2") inline void GF128ClMulAccumulate(__m128i a, __m128i b, __m128i& lo, __m128i& mid, __m128i& hi) noexcept {
+		lo  = _mm_xor_si128(lo, _mm_clmulepi64_si128(a, b, 0x00));
+		mid = _mm_xor_si128(mid, _mm_xor_si128(_mm_clmulepi64_si128(a, b, 0x10), _mm_clmulepi64_si128(a, b, 0x01)));
+		hi  = _mm_xor_si128(hi, _mm_clmulepi64_si128(a, b, 0x11));
+	}
+
+	// Operands are byte-reflected, so the 256-bit product is shifted left by one bit before the reduction modulo x^128 + x^7 + x^2 + x + 1.
+	_CRYPTOAES_TARGET("pclmul,sse2") inline __m128i GF128Reduce(__m128i lo, __m128i mid, __m128i hi) noexcept {
+		lo = _mm_xor_si128(lo, _mm_slli_si128(mid, 8));
+		hi = _mm_xor_si128(hi, _mm_srli_si128(mid, 8));
+
+		const __m128i loCarry = _mm_srli_epi32(lo, 31);
+		const __m128i hiCarry = _mm_srli_epi32(hi, 31);
+
+		lo = _mm_or_si128(_mm_slli_epi32(lo, 1), _mm_slli_si128(loCarry, 4));
+		hi = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(hi, 1), _mm_slli_si128(hiCarry, 4)), _mm_srli_si128(loCarry, 12));
+
+		__m128i t = _mm_xor_si128(_mm_xor_si128(_mm_slli_epi32(lo, 31), _mm_slli_epi32(lo, 30)), _mm_slli_epi32(lo, 25));
+		const __m128i tHi = _mm_srli_si128(t, 4);
+		lo = _mm_xor_si128(lo, _mm_slli_si128(t, 12));
+
+		t = _mm_xor_si128(_mm_xor_si128(_mm_srli_epi32(lo, 1), _mm_srli_epi32(lo, 2)), _mm_srli_epi32(lo, 7));
+		t = _mm_xor_si128(t, tHi);
+
+		return _mm_xor_si128(hi, _mm_xor_si128(lo, t));
+	}
+
+	_CRYPTOAES_TARGET("pclmul,sse2") inline __m128i GF128MulPCLMUL(__m128i a, __m128i b) noexcept {
+		__m128i lo = _mm_setzero_si128();
+		__m128i mid = _mm_setzero_si128();
+		__m128i hi = _mm_setzero_si128();
+		GF128ClMulAccumulate(a, b, lo, mid, hi);
+		return GF128Reduce(lo, mid, hi);
+	}
+
+	_CRYPTOAES_TARGET("pclmul,ssse3") inline void GHashAccamulatePCLMUL(const block16& H, const unsigned char* pData, std::size_t unDataLength, block16& accumulator) noexcept {
+		const __m128i kByteSwap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+
+		const __m128i H1 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(H.data())), kByteSwap);
+		__m128i Y = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(accumulator.data())), kByteSwap);
+
+		std::size_t unOffset = 0;
+
+		if (unDataLength >= 64) {
+			const __m128i H2 = GF128MulPCLMUL(H1, H1);
+			const __m128i H3 = GF128MulPCLMUL(H2, H1);
+			const __m128i H4 = GF128MulPCLMUL(H3, H1);
+
+			for (; unOffset + 64 <= unDataLength; unOffset += 64) {
+				const __m128i X0 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pData + unOffset)), kByteSwap);
+				const __m128i X1 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pData + unOffset + 16)), kByteSwap);
+				const __m128i X2 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pData + unOffset + 32)), kByteSwap);
+				const __m128i X3 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pData + unOffset + 48)), kByteSwap);
+
+				__m128i lo = _mm_setzero_si128();
+				__m128i mid = _mm_setzero_si128();
+				__m128i hi = _mm_setzero_si128();
+
+				GF128ClMulAccumulate(_mm_xor_si128(Y, X0), H4, lo, mid, hi);
+				GF128ClMulAccumulate(X1, H3, lo, mid, hi);
+				GF128ClMulAccumulate(X2, H2, lo, mid, hi);
+				GF128ClMulAccumulate(X3, H1, lo, mid, hi);
+
+				Y = GF128Reduce(lo, mid, hi);
+			}
+		}
+
+		for (; unOffset + 16 <= unDataLength; unOffset += 16) {
+			const __m128i X = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pData + unOffset)), kByteSwap);
+			Y = GF128MulPCLMUL(_mm_xor_si128(Y, X), H1);
+		}
+
+		if (unOffset < unDataLength) {
+			block16 last {};
+			for (std::size_t i = 0; unOffset + i < unDataLength; ++i) {
+				last[i] = pData[unOffset + i];
+			}
+
+			const __m128i X = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(last.data())), kByteSwap);
+			Y = GF128MulPCLMUL(_mm_xor_si128(Y, X), H1);
+		}
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(accumulator.data()), _mm_shuffle_epi8(Y, kByteSwap));
+	}
+#endif
+
+	class GHashEngine {
+	public:
+		explicit GHashEngine(const block16& H) noexcept : m_H(H) {
+#ifdef _CRYPTOAES_X86
+			m_bPCLMUL = UsePCLMUL();
+			if (m_bPCLMUL) {
+				return;
+			}
+#endif
+
+			m_Table = GHashTable(H);
+		}
+
+		GHashEngine(const GHashEngine&) = delete;
+		GHashEngine& operator=(const GHashEngine&) = delete;
+
+		~GHashEngine() noexcept {
+			SecureWipe(&m_H, sizeof(m_H));
+			SecureWipe(&m_Table, sizeof(m_Table));
+		}
+
+	public:
+		void Update(const unsigned char* pData, std::size_t unDataLength, block16& accumulator) const noexcept {
+#ifdef _CRYPTOAES_X86
+			if (m_bPCLMUL) {
+				GHashAccamulatePCLMUL(m_H, pData, unDataLength, accumulator);
+				return;
+			}
+#endif
+
+#ifdef _CRYPTOAES_CONSTANT_TIME
+			GHashAccamulateTable<true>(m_Table, pData, unDataLength, accumulator);
+#else
+			GHashAccamulateTable<false>(m_Table, pData, unDataLength, accumulator);
+#endif
+		}
+
+	private:
+		block16 m_H {};
+		GHashTable m_Table {};
+#ifdef _CRYPTOAES_X86
+		bool m_bPCLMUL = false;
+#endif
+	};
+
+	// Compares the first unSize bytes, so truncated 8- and 12-byte tags go through the same check.
+	constexpr int compare_block16_ct(const block16& a, const block16& b, std::size_t unSize = 16) noexcept {
+		unsigned char unDiff = 0;
+		for (std::size_t i = 0; i < unSize; ++i) {
+			unDiff |= a[i] ^ b[i];
+		}
+
+		return unDiff;
+	}
+
+#ifdef _CRYPTOAES_X86
+	// Stitched AES-CTR + GHASH: the eight ciphertext blocks of an iteration are hashed between the AESENC rounds that produce their keystream.
+	_CRYPTOAES_TARGET("aes,pclmul,ssse3") inline void GCMDecryptAndHashAESNI(const GCMPrecomputed& pre, const block16& J0, const unsigned char* pIn, std::size_t unSize, unsigned char* pOut, block16& S) noexcept {
+		const __m128i kByteSwap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+
+		const unsigned int unRounds = pre.m_RoundKeys.m_unRounds;
+
+		__m128i RK[15];
+		for (unsigned char i = 0; i < 15; ++i) {
+			RK[i] = _mm_load_si128(reinterpret_cast<const __m128i*>(pre.m_RoundKeys.m_Data[i]));
+		}
+
+		__m128i HP[8];
+		HP[0] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pre.m_H.data())), kByteSwap);
+		for (unsigned char i = 1; i < 8; ++i) {
+			HP[i] = GF128MulPCLMUL(HP[i - 1], HP[0]);
+		}
+
+		__m128i Y = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(S.data())), kByteSwap);
+
+		const __m128i nonce = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(J0.data())), _mm_set_epi32(0, -1, -1, -1));
+		unsigned int unCounter = be32(&J0[12]);
+
+		std::size_t unOffset = 0;
+		for (; unOffset + 128 <= unSize; unOffset += 128) {
+			__m128i C[8];
+			__m128i B[8];
+			for (unsigned char i = 0; i < 8; ++i) {
+				C[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pIn + unOffset + 16 * i));
+				B[i] = _mm_xor_si128(MakeCounterBlock(nonce, unCounter + 1 + i), RK[0]);
+			}
+
+			unCounter += 8;
+
+			__m128i lo = _mm_setzero_si128();
+			__m128i mid = _mm_setzero_si128();
+			__m128i hi = _mm_setzero_si128();
+
+			for (unsigned int unR = 1; unR < unRounds; ++unR) {
+				for (unsigned char i = 0; i < 8; ++i) {
+					B[i] = _mm_aesenc_si128(B[i], RK[unR]);
+				}
+
+				if (unR <= 8) {
+					__m128i X = _mm_shuffle_epi8(C[unR - 1], kByteSwap);
+					if (unR == 1) {
+						X = _mm_xor_si128(X, Y);
+					}
+
+					GF128ClMulAccumulate(X, HP[8 - unR], lo, mid, hi);
+				}
+			}
+
+			for (unsigned char i = 0; i < 8; ++i) {
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(pOut + unOffset + 16 * i), _mm_xor_si128(C[i], _mm_aesenclast_si128(B[i], RK[unRounds])));
+			}
+
+			Y = GF128Reduce(lo, mid, hi);
+		}
+
+		for (; unOffset + 16 <= unSize; unOffset += 16) {
+			const __m128i C = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pIn + unOffset));
+			Y = GF128MulPCLMUL(_mm_xor_si128(Y, _mm_shuffle_epi8(C, kByteSwap)), HP[0]);
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pOut + unOffset), _mm_xor_si128(C, AESEncryptBlockAESNI(MakeCounterBlock(nonce, ++unCounter), RK, unRounds)));
+		}
+
+		if (unOffset < unSize) {
+			block16 last {};
+			for (std::size_t i = 0; unOffset + i < unSize; ++i) {
+				last[i] = pIn[unOffset + i];
+			}
+
+			Y = GF128MulPCLMUL(_mm_xor_si128(Y, _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(last.data())), kByteSwap)), HP[0]);
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(last.data()), AESEncryptBlockAESNI(MakeCounterBlock(nonce, ++unCounter), RK, unRounds));
+			for (std::size_t i = 0; unOffset + i < unSize; ++i) {
+				pOut[unOffset + i] = static_cast<unsigned char>(pIn[unOffset + i] ^ last[i]);
+			}
+
+			SecureWipe(&last, sizeof(last));
+		}
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(S.data()), _mm_shuffle_epi8(Y, kByteSwap));
+
+		// HP holds powers of the GHASH key, which are as sensitive as H itself.
+		SecureWipe(RK, sizeof(RK));
+		SecureWipe(HP, sizeof(HP));
+	}
+#endif
+
+	// Decrypts pIn and folds it into the GHASH accumulator S in one pass. Without AES-NI + PCLMULQDQ the work is split
+	// into small chunks so every chunk is hashed and decrypted while it is still in L1.
+	inline void GCMDecryptAndHash(const GCMPrecomputed& pre, const GHashEngine& ghash, const block16& J0, const unsigned char* pIn, std::size_t unSize, unsigned char* pOut, block16& S) noexcept {
+#ifdef _CRYPTOAES_X86
+		if (UseAESNI() && UsePCLMUL()) {
+			GCMDecryptAndHashAESNI(pre, J0, pIn, unSize, pOut, S);
+			return;
+		}
+#endif
+
+		constexpr std::size_t kChunk = 512;
+
+		block16 ctr = J0;
+		for (std::size_t unOffset = 0; unOffset < unSize; unOffset += kChunk) {
+			const std::size_t unChunk = (unOffset + kChunk <= unSize) ? kChunk : (unSize - unOffset);
+
+			ghash.Update(pIn + unOffset, unChunk, S);
+			AESCTR(pre.m_RoundKeys, ctr, pIn + unOffset, unChunk, pOut + unOffset);
+
+			put_be32(&ctr[12], be32(&ctr[12]) + static_cast<unsigned int>(kChunk / 16));
+		}
+	}
+
+	constexpr block16 GCMMakeJ0(const iv12& iv) noexcept {
+		block16 J0 {};
+		for (unsigned char i = 0; i < 12; ++i) {
+			J0[i] = iv[i];
+		}
+
+		J0[15] = 1;
+
+		return J0;
+	}
+
+	_CRYPTOAES_ENGINE void GCMPrepare(const block32& key, const iv12& iv, GCMPrecomputed& pre, std::size_t unKeyBytes = 32) noexcept {
+		pre.m_RoundKeys = AESRoundKeys(AESKeySchedule(key, unKeyBytes));
+
+		block16 blocks[2] { {}, GCMMakeJ0(iv) };
+
+		AESECB(pre.m_RoundKeys, blocks, 2);
+		pre.m_H = blocks[0];
+		pre.m_EncJ0 = blocks[1];
+
+		SecureWipe(blocks, sizeof(blocks));
+	}
+
+	// Folds the length block into S and compares E(K, J0) ^ S against the first unTagSize bytes of tag.
+	inline bool GCMCheckTag(const GHashEngine& ghash, block16& S, std::size_t unAADSize, std::size_t unCipherTextSize, const GCMPrecomputed& pre, const block16& tag, std::size_t unTagSize) noexcept {
+		block16 lenblock {};
+
+		const unsigned long long unAADBits = static_cast<unsigned long long>(unAADSize) * 8ull;
+		const unsigned long long unCipherBits = static_cast<unsigned long long>(unCipherTextSize) * 8ull;
+
+		for (unsigned char i = 0; i < 8; ++i) {
+			lenblock[i] = static_cast<unsigned char>((unAADBits >> (56 - 8 * i)) & 0xFF);
+		}
+
+		for (unsigned char i = 0; i < 8; ++i) {
+			lenblock[8 + i] = static_cast<unsigned char>((unCipherBits >> (56 - 8 * i)) & 0xFF);
+		}
+
+		ghash.Update(lenblock.data(), lenblock.size(), S);
+
+		block16 computed_tag {};
+		for (unsigned char i = 0; i < 16; ++i) {
+			computed_tag[i] = static_cast<unsigned char>(pre.m_EncJ0[i] ^ S[i]);
+		}
+
+		return compare_block16_ct(computed_tag, tag, unTagSize) == 0;
+	}
+
+	inline bool GCMDecrypt(const unsigned char* pCipherText, std::size_t unCipherTextSize, const unsigned char* pAAD, std::size_t unAADSize, const block16& tag, const GCMPrecomputed& pre, const iv12& iv, unsigned char* pPlainText, std::size_t unTagSize = 16) noexcept {
+		const block16 J0 = GCMMakeJ0(iv);
+		const GHashEngine ghash(pre.m_H);
+
+		block16 S {};
+		if (unAADSize > 0) {
+			ghash.Update(pAAD, unAADSize, S);
+		}
+
+		GCMDecryptAndHash(pre, ghash, J0, pCipherText, unCipherTextSize, pPlainText, S);
+
+		return GCMCheckTag(ghash, S, unAADSize, unCipherTextSize, pre, tag, unTagSize);
+	}
+
+	_CRYPTOAES_ENGINE bool GCMDecrypt(const unsigned char* pCipherText, std::size_t unCipherTextSize, const unsigned char* pAAD, std::size_t unAADSize, const block16& tag, const block32& key, const iv12& iv, unsigned char* pPlainText) noexcept {
+		GCMPrecomputed pre {};
+		GCMPrepare(key, iv, pre);
+
+		const bool bResult = GCMDecrypt(pCipherText, unCipherTextSize, pAAD, unAADSize, tag, pre, iv, pPlainText);
+
+		SecureWipe(&pre, sizeof(pre));
+
+		return bResult;
+	}
+
+	// Authenticates without producing any plaintext; only GHASH runs over the ciphertext.
+	_CRYPTOAES_ENGINE bool GCMVerify(const unsigned char* pCipherText, std::size_t unCipherTextSize, const unsigned char* pAAD, std::size_t unAADSize, const block16& tag, const GCMPrecomputed& pre, std::size_t unTagSize = 16) noexcept {
+		const GHashEngine ghash(pre.m_H);
+
+		block16 S {};
+		if (unAADSize > 0) {
+			ghash.Update(pAAD, unAADSize, S);
+		}
+
+		ghash.Update(pCipherText, unCipherTextSize, S);
+
+		return GCMCheckTag(ghash, S, unAADSize, unCipherTextSize, pre, tag, unTagSize);
+	}
+
+	// Decrypts unSize bytes starting at byte offset unOffset of a CTR stream, touching only the blocks that cover the range.
+	_CRYPTOAES_ENGINE void GCMDecryptRange(const GCMPrecomputed& pre, const iv12& iv, const unsigned char* pCipherText, std::size_t unOffset, std::size_t unSize, unsigned char* pOut) noexcept {
+		if (unSize == 0) {
+			return;
+		}
+
+		block16 ctr = GCMMakeJ0(iv);
+		put_be32(&ctr[12], be32(&ctr[12]) + static_cast<unsigned int>(unOffset >> 4));
+
+		const std::size_t unHead = unOffset & 15;
+		if (unHead != 0) {
+			block16 block {};
+			for (std::size_t i = 0; (i < 16 - unHead) && (i < unSize); ++i) {
+				block[unHead + i] = pCipherText[unOffset + i];
+			}
+
+			const std::size_t unTaken = (unSize < 16 - unHead) ? unSize : (16 - unHead);
+
+			AESCTR(pre.m_RoundKeys, ctr, block.data(), 16, block.data());
+
+			for (std::size_t i = 0; i < unTaken; ++i) {
+				pOut[i] = block[unHead + i];
+			}
+
+			SecureWipe(&block, sizeof(block));
+
+			inc32_inplace(ctr);
+			unOffset += unTaken;
+			unSize -= unTaken;
+			pOut += unTaken;
+		}
+
+		if (unSize > 0) {
+			AESCTR(pre.m_RoundKeys, ctr, pCipherText + unOffset, unSize, pOut);
+		}
+	}
+
+
+	// A site's blob handed to the engine as plain data, so the per-site code is just filling this in. m_pIV may point at an
+	// IV the site re-derived instead of one stored in the blob; m_pTag holds m_unTagSize bytes.
+	struct GCMBlob {
+		const unsigned char* m_pIV;
+		const unsigned char* m_pCipherText;
+		std::size_t m_unCipherTextSize;
+		const unsigned char* m_pTag;
+		std::size_t m_unTagSize = 16;
+		std::size_t m_unKeyBytes = 32;
+	};
+
+	// Decrypts and authenticates a blob into pPlainText. The key is wiped before returning, and so is pPlainText if the tag does not verify.
+	_CRYPTOAES_ENGINE bool GCMOpen(const GCMBlob& blob, block32& key, unsigned char* pPlainText) noexcept {
+		iv12 iv {};
+		for (unsigned char i = 0; i < 12; ++i) {
+			iv[i] = blob.m_pIV[i];
+		}
+
+		block16 tag {};
+		for (std::size_t i = 0; i < blob.m_unTagSize; ++i) {
+			tag[i] = blob.m_pTag[i];
+		}
+
+		GCMPrecomputed pre {};
+		GCMPrepare(key, iv, pre, blob.m_unKeyBytes);
+
+		SecureWipe(&key, sizeof(key));
+
+		const bool bValid = GCMDecrypt(blob.m_pCipherText, blob.m_unCipherTextSize, kAAD, kAADSize, tag, pre, iv, pPlainText, blob.m_unTagSize);
+
+		SecureWipe(&pre, sizeof(pre));
+
+		if (!bValid) {
+			SecureWipe(pPlainText, blob.m_unCipherTextSize);
+		}
+
+		return bValid;
+	}
+
+	// Unmasks a GCMPrecomputed stored by MakeBlob; the mask is wiped afterwards.
+	_CRYPTOAES_ENGINE void GCMLoad(const unsigned char* pPrecomputed, Bytes<64>& mask, GCMPrecomputed& pre) noexcept {
+		pre.Load(pPrecomputed, mask);
+
+		SecureWipe(&mask, sizeof(mask));
+	}
+
+	// Same as above for blobs that carry a masked GCMPrecomputed instead of deriving the key schedule at runtime.
+	_CRYPTOAES_ENGINE bool GCMOpen(const GCMBlob& blob, const unsigned char* pPrecomputed, Bytes<64>& mask, unsigned char* pPlainText) noexcept {
+		GCMPrecomputed pre {};
+		GCMLoad(pPrecomputed, mask, pre);
+
+		iv12 iv {};
+		for (unsigned char i = 0; i < 12; ++i) {
+			iv[i] = blob.m_pIV[i];
+		}
+
+		block16 tag {};
+		for (std::size_t i = 0; i < blob.m_unTagSize; ++i) {
+			tag[i] = blob.m_pTag[i];
+		}
+
+		const bool bValid = GCMDecrypt(blob.m_pCipherText, blob.m_unCipherTextSize, kAAD, kAADSize, tag, pre, iv, pPlainText, blob.m_unTagSize);
+
+		SecureWipe(&pre, sizeof(pre));
+
+		if (!bValid) {
+			SecureWipe(pPlainText, blob.m_unCipherTextSize);
+		}
+
+		return bValid;
+	}
+
+	// ----------------------------------------------------------------
+	// ChaCha20-Poly1305 (RFC 8439)
+	// ----------------------------------------------------------------
+
+	// ARX alternative to AES-GCM: cheaper to evaluate at compile time and, without AES-NI, faster at runtime than
+	// table AES. Sites pick it through their Cipher template parameter; CRYPTOAES_CHACHA20POLY1305 makes it the default.
+	enum class Cipher : unsigned char {
+		AESGCM,
+		ChaCha20Poly1305
+	};
+
+#ifdef CRYPTOAES_CHACHA20POLY1305
+	constexpr static Cipher kDefaultCipher = Cipher::ChaCha20Poly1305;
+#else
+	constexpr static Cipher kDefaultCipher = Cipher::AESGCM;
+#endif
+
+	constexpr unsigned int ChaChaRotate(unsigned int unX, unsigned int unN) noexcept {
+		return (unX << unN) | (unX >> (32u - unN));
+	}
+
+	constexpr void ChaChaQuarterRound(unsigned int(&X)[16], unsigned char a, unsigned char b, unsigned char c, unsigned char d) noexcept {
+		X[a] += X[b]; X[d] = ChaChaRotate(X[d] ^ X[a], 16);
+		X[c] += X[d]; X[b] = ChaChaRotate(X[b] ^ X[c], 12);
+		X[a] += X[b]; X[d] = ChaChaRotate(X[d] ^ X[a],  8);
+		X[c] += X[d]; X[b] = ChaChaRotate(X[b] ^ X[c],  7);
+	}
+
+	// "expand 32-byte k", the key, the block counter and the 96-bit nonce.
+	constexpr void ChaChaSetup(const block32& key, const iv12& nonce, unsigned int unCounter, unsigned int(&State)[16]) noexcept {
+		State[0] = 0x61707865;
+		State[1] = 0x3320646E;
+		State[2] = 0x79622D32;
+		State[3] = 0x6B206574;
+
+		for (unsigned char i = 0; i < 8; ++i) {
+			State[4 + i] = le32(&key[4 * i]);
+		}
+
+		State[12] = unCounter;
+		State[13] = le32(&nonce[0]);
+		State[14] = le32(&nonce[4]);
+		State[15] = le32(&nonce[8]);
+	}
+
+	constexpr void ChaCha20Block(const unsigned int(&State)[16], unsigned char* pOut) noexcept {
+		unsigned int X[16] {};
+		for (unsigned char i = 0; i < 16; ++i) {
+			X[i] = State[i];
+		}
+
+		for (unsigned char i = 0; i < 10; ++i) {
+			ChaChaQuarterRound(X, 0, 4,  8, 12);
+			ChaChaQuarterRound(X, 1, 5,  9, 13);
+			ChaChaQuarterRound(X, 2, 6, 10, 14);
+			ChaChaQuarterRound(X, 3, 7, 11, 15);
+			ChaChaQuarterRound(X, 0, 5, 10, 15);
+			ChaChaQuarterRound(X, 1, 6, 11, 12);
+			ChaChaQuarterRound(X, 2, 7,  8, 13);
+			ChaChaQuarterRound(X, 3, 4,  9, 14);
+		}
+
+		for (unsigned char i = 0; i < 16; ++i) {
+			put_le32(pOut + 4 * i, X[i] + State[i]);
+		}
+	}
+
+	// Poly1305 on five 26-bit limbs, so it needs nothing wider than 64-bit products and works in constant evaluation.
+	class Poly1305 {
+	public:
+		constexpr explicit Poly1305(const block32& key) noexcept {
+			m_R[0] =  le32(&key[ 0])       & 0x3FFFFFF;
+			m_R[1] = (le32(&key[ 3]) >> 2) & 0x3FFFF03;
+			m_R[2] = (le32(&key[ 6]) >> 4) & 0x3FFC0FF;
+			m_R[3] = (le32(&key[ 9]) >> 6) & 0x3F03FFF;
+			m_R[4] = (le32(&key[12]) >> 8) & 0x00FFFFF;
+
+			for (unsigned char i = 0; i < 4; ++i) {
+				m_Pad[i] = le32(&key[16 + 4 * i]);
+			}
+		}
+
+		// Absorbs pData zero-padded to a multiple of 16 bytes, which is how the AEAD feeds both the AAD and the ciphertext.
+		constexpr void UpdatePadded(const unsigned char* pData, std::size_t unSize) noexcept {
+			for (std::size_t unOffset = 0; unOffset < unSize; unOffset += 16) {
+				unsigned char block[16] {};
+
+				const std::size_t unChunk = (unOffset + 16 <= unSize) ? 16 : (unSize - unOffset);
+				for (std::size_t i = 0; i < unChunk; ++i) {
+					block[i] = pData[unOffset + i];
+				}
+
+				Block(block);
+			}
+		}
+
+		constexpr void UpdateLengths(unsigned long long unAADSize, unsigned long long unCipherTextSize) noexcept {
+			unsigned char block[16] {};
+			for (unsigned char i = 0; i < 8; ++i) {
+				block[i]     = static_cast<unsigned char>((unAADSize        >> (8 * i)) & 0xFF);
+				block[8 + i] = static_cast<unsigned char>((unCipherTextSize >> (8 * i)) & 0xFF);
+			}
+
+			Block(block);
+		}
+
+		constexpr block16 Finish() noexcept {
+			unsigned int h0 = m_H[0], h1 = m_H[1], h2 = m_H[2], h3 = m_H[3], h4 = m_H[4];
+
+			unsigned int c = h1 >> 26; h1 &= 0x3FFFFFF;
+			h2 += c; c = h2 >> 26; h2 &= 0x3FFFFFF;
+			h3 += c; c = h3 >> 26; h3 &= 0x3FFFFFF;
+			h4 += c; c = h4 >> 26; h4 &= 0x3FFFFFF;
+			h0 += c * 5; c = h0 >> 26; h0 &= 0x3FFFFFF;
+			h1 += c;
+
+			// Select h - p when h >= p = 2^130 - 5, without branching.
+			unsigned int g0 = h0 + 5; c = g0 >> 26; g0 &= 0x3FFFFFF;
+			unsigned int g1 = h1 + c; c = g1 >> 26; g1 &= 0x3FFFFFF;
+			unsigned int g2 = h2 + c; c = g2 >> 26; g2 &= 0x3FFFFFF;
+			unsigned int g3 = h3 + c; c = g3 >> 26; g3 &= 0x3FFFFFF;
+			unsigned int g4 = h4 + c - (1u << 26);
+
+			const unsigned int unMask = (g4 >> 31) - 1u;
+			h0 = (h0 & ~unMask) | (g0 & unMask);
+			h1 = (h1 & ~unMask) | (g1 & unMask);
+			h2 = (h2 & ~unMask) | (g2 & unMask);
+			h3 = (h3 & ~unMask) | (g3 & unMask);
+			h4 = (h4 & ~unMask) | (g4 & unMask);
+
+			const unsigned int unWords[4] = { h0 | (h1 << 26), (h1 >> 6) | (h2 << 20), (h2 >> 12) | (h3 << 14), (h3 >> 18) | (h4 << 8) };
+
+			block16 tag {};
+			unsigned long long unCarry = 0;
+			for (unsigned char i = 0; i < 4; ++i) {
+				unCarry += static_cast<unsigned long long>(unWords[i]) + m_Pad[i];
+				put_le32(&tag[4 * i], static_cast<unsigned int>(unCarry));
+				unCarry >>= 32;
+			}
+
+			return tag;
+		}
+
+	private:
+		constexpr void Block(const unsigned char* pBlock) noexcept {
+			using u64 = unsigned long long;
+
+			const unsigned int r0 = m_R[0], r1 = m_R[1], r2 = m_R[2], r3 = m_R[3], r4 = m_R[4];
+			const unsigned int s1 = r1 * 5, s2 = r2 * 5, s3 = r3 * 5, s4 = r4 * 5;
+
+			const unsigned int h0 = m_H[0] + ( le32(pBlock +  0)       & 0x3FFFFFF);
+			const unsigned int h1 = m_H[1] + ((le32(pBlock +  3) >> 2) & 0x3FFFFFF);
+			const unsigned int h2 = m_H[2] + ((le32(pBlock +  6) >> 4) & 0x3FFFFFF);
+			const unsigned int h3 = m_H[3] + ((le32(pBlock +  9) >> 6) & 0x3FFFFFF);
+			const unsigned int h4 = m_H[4] + ((le32(pBlock + 12) >> 8) | (1u << 24));
+
+			const u64 d0 = u64(h0) * r0 + u64(h1) * s4 + u64(h2) * s3 + u64(h3) * s2 + u64(h4) * s1;
+			u64       d1 = u64(h0) * r1 + u64(h1) * r0 + u64(h2) * s4 + u64(h3) * s3 + u64(h4) * s2;
+			u64       d2 = u64(h0) * r2 + u64(h1) * r1 + u64(h2) * r0 + u64(h3) * s4 + u64(h4) * s3;
+			u64       d3 = u64(h0) * r3 + u64(h1) * r2 + u64(h2) * r1 + u64(h3) * r0 + u64(h4) * s4;
+			u64       d4 = u64(h0) * r4 + u64(h1) * r3 + u64(h2) * r2 + u64(h3) * r1 + u64(h4) * r0;
+
+			d1 += d0 >> 26; m_H[0] = static_cast<unsigned int>(d0) & 0x3FFFFFF;
+			d2 += d1 >> 26; m_H[1] = static_cast<unsigned int>(d1) & 0x3FFFFFF;
+			d3 += d2 >> 26; m_H[2] = static_cast<unsigned int>(d2) & 0x3FFFFFF;
+			d4 += d3 >> 26; m_H[3] = static_cast<unsigned int>(d3) & 0x3FFFFFF;
+			m_H[4] = static_cast<unsigned int>(d4) & 0x3FFFFFF;
+
+			m_H[0] += static_cast<unsigned int>(d4 >> 26) * 5;
+			m_H[1] += m_H[0] >> 26;
+			m_H[0] &= 0x3FFFFFF;
+		}
+
+		unsigned int m_R[5] {};
+		unsigned int m_H[5] {};
+		unsigned int m_Pad[4] {};
+	};
+
+	// The one-time Poly1305 key is the first half of keystream block 0; payload encryption starts at block 1.
+	constexpr block32 ChaChaPolyKey(const block32& key, const iv12& nonce) noexcept {
+		unsigned int State[16] {};
+		ChaChaSetup(key, nonce, 0, State);
+
+		unsigned char block[64] {};
+		ChaCha20Block(State, block);
+
+		block32 out {};
+		for (unsigned char i = 0; i < 32; ++i) {
+			out[i] = block[i];
+		}
+
+		return out;
+	}
+
+	template <std::size_t unDataSize, std::size_t unAADSize = 0>
+	constexpr GCMResult<unDataSize> ChaChaPolyEncrypt(const unsigned char* pPlainText, const unsigned char* pAAD, const block32& key, const iv12& nonce) noexcept {
+		GCMResult<unDataSize> out {};
+
+		unsigned int State[16] {};
+		ChaChaSetup(key, nonce, 1, State);
+
+		for (std::size_t unOffset = 0; unOffset < unDataSize; unOffset += 64) {
+			unsigned char keystream[64] {};
+			ChaCha20Block(State, keystream);
+			++State[12];
+
+			const std::size_t unChunk = (unOffset + 64 <= unDataSize) ? 64 : (unDataSize - unOffset);
+			for (std::size_t i = 0; i < unChunk; ++i) {
+				out.m_CipherText[unOffset + i] = static_cast<unsigned char>(pPlainText[unOffset + i] ^ keystream[i]);
+			}
+		}
+
+		Poly1305 mac(ChaChaPolyKey(key, nonce));
+		mac.UpdatePadded(pAAD, unAADSize);
+		mac.UpdatePadded(out.m_CipherText, unDataSize);
+		mac.UpdateLengths(unAADSize, unDataSize);
+
+		out.m_Tag = mac.Finish();
+
+		return out;
+	}
+
+	// Counterpart of GCMPrecomputed: the ChaCha key and the one-time Poly1305 key, stored masked in the blob.
+	struct ChaChaPrecomputed {
+		static constexpr std::size_t kSize = 64;
+
+		constexpr ChaChaPrecomputed() noexcept = default;
+		constexpr ChaChaPrecomputed(const block32& key, const iv12& nonce) noexcept : m_Key(key), m_PolyKey(ChaChaPolyKey(key, nonce)) {}
+
+		template<std::size_t unMaskSize>
+		constexpr void Store(unsigned char* pOut, const Bytes<unMaskSize>& mask) const noexcept {
+			for (std::size_t i = 0; i < kSize; ++i) {
+				pOut[i] = static_cast<unsigned char>(((i < 32) ? m_Key[i] : m_PolyKey[i - 32]) ^ mask[i % unMaskSize]);
+			}
+		}
+
+		template<std::size_t unMaskSize>
+		constexpr void Load(const unsigned char* pIn, const Bytes<unMaskSize>& mask) noexcept {
+			for (std::size_t i = 0; i < kSize; ++i) {
+				((i < 32) ? m_Key[i] : m_PolyKey[i - 32]) = static_cast<unsigned char>(pIn[i] ^ mask[i % unMaskSize]);
+			}
+		}
+
+		block32 m_Key {};
+		block32 m_PolyKey {};
+	};
+
+	inline void ChaCha20XORPortable(const unsigned int(&State)[16], const unsigned char* pIn, std::size_t unSize, unsigned char* pOut) noexcept {
+		unsigned int S[16] {};
+		for (unsigned char i = 0; i < 16; ++i) {
+			S[i] = State[i];
+		}
+
+		unsigned char keystream[64] {};
+
+		for (std::size_t unOffset = 0; unOffset < unSize; unOffset += 64) {
+			ChaCha20Block(S, keystream);
+			++S[12];
+
+			const std::size_t unChunk = (unOffset + 64 <= unSize) ? 64 : (unSize - unOffset);
+			for (std::size_t i = 0; i < unChunk; ++i) {
+				pOut[unOffset + i] = static_cast<unsigned char>(pIn[unOffset + i] ^ keystream[i]);
+			}
+		}
+
+		SecureWipe(S, sizeof(S));
+		SecureWipe(keystream, sizeof(keystream));
+	}
+
+#ifdef _CRYPTOAES_X86
+	// Four blocks per iteration, one state word of every block per register; the rows are transposed back on output.
+	_CRYPTOAES_TARGET("sse2") inline __m128i ChaChaRotateSSE2(__m128i X, int nN) noexcept {
+		return _mm_or_si128(_mm_slli_epi32(X, nN), _mm_srli_epi32(X, 32 - nN));
+	}
+
+	_CRYPTOAES_TARGET("sse2") inline void ChaChaQuarterRoundSSE2(__m128i& a, __m128i& b, __m128i& c, __m128i& d) noexcept {
+		a = _mm_add_epi32(a, b); d = ChaChaRotateSSE2(_mm_xor_si128(d, a), 16);
+		c = _mm_add_epi32(c, d); b = ChaChaRotateSSE2(_mm_xor_si128(b, c), 12);
+		a = _mm_add_epi32(a, b); d = ChaChaRotateSSE2(_mm_xor_si128(d, a),  8);
+		c = _mm_add_epi32(c, d); b = ChaChaRotateSSE2(_mm_xor_si128(b, c),  7);
+	}
+
+	// Returns how many bytes were processed (whole 256-byte groups); the caller finishes the tail.
+	_CRYPTOAES_TARGET("sse2") inline std::size_t ChaCha20XORSSE2(unsigned int(&State)[16], const unsigned char* pIn, std::size_t unSize, unsigned char* pOut) noexcept {
+		std::size_t unOffset = 0;
+
+		for (; unOffset + 256 <= unSize; unOffset += 256) {
+			__m128i X[16];
+			__m128i B[16];
+			for (unsigned char i = 0; i < 16; ++i) {
+				B[i] = _mm_set1_epi32(static_cast<int>(State[i]));
+			}
+
+			B[12] = _mm_add_epi32(B[12], _mm_set_epi32(3, 2, 1, 0));
+
+			for (unsigned char i = 0; i < 16; ++i) {
+				X[i] = B[i];
+			}
+
+			for (unsigned char i = 0; i < 10; ++i) {
+				ChaChaQuarterRoundSSE2(X[0], X[4], X[ 8], X[12]);
+				ChaChaQuarterRoundSSE2(X[1], X[5], X[ 9], X[13]);
+				ChaChaQuarterRoundSSE2(X[2], X[6], X[10], X[14]);
+				ChaChaQuarterRoundSSE2(X[3], X[7], X[11], X[15]);
+				ChaChaQuarterRoundSSE2(X[0], X[5], X[10], X[15]);
+				ChaChaQuarterRoundSSE2(X[1], X[6], X[11], X[12]);
+				ChaChaQuarterRoundSSE2(X[2], X[7], X[ 8], X[13]);
+				ChaChaQuarterRoundSSE2(X[3], X[4], X[ 9], X[14]);
+			}
+
+			for (unsigned char g = 0; g < 4; ++g) {
+				const __m128i a = _mm_add_epi32(X[4 * g],     B[4 * g]);
+				const __m128i b = _mm_add_epi32(X[4 * g + 1], B[4 * g + 1]);
+				const __m128i c = _mm_add_epi32(X[4 * g + 2], B[4 * g + 2]);
+				const __m128i d = _mm_add_epi32(X[4 * g + 3], B[4 * g + 3]);
+
+				const __m128i ab0 = _mm_unpacklo_epi32(a, b), ab1 = _mm_unpackhi_epi32(a, b);
+				const __m128i cd0 = _mm_unpacklo_epi32(c, d), cd1 = _mm_unpackhi_epi32(c, d);
+
+				const __m128i K[4] = { _mm_unpacklo_epi64(ab0, cd0), _mm_unpackhi_epi64(ab0, cd0), _mm_unpacklo_epi64(ab1, cd1), _mm_unpackhi_epi64(ab1, cd1) };
+
+				for (unsigned char j = 0; j < 4; ++j) {
+					const std::size_t unAt = unOffset + 64 * j + 16 * g;
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(pOut + unAt), _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pIn + unAt)), K[j]));
+				}
+			}
+
+			State[12] += 4;
+		}
+
+		return unOffset;
+	}
+
+	_CRYPTOAES_TARGET("avx2") inline __m256i ChaChaRotateAVX2(__m256i X, int nN) noexcept {
+		return _mm256_or_si256(_mm256_slli_epi32(X, nN), _mm256_srli_epi32(X, 32 - nN));
+	}
+
+	_CRYPTOAES_TARGET("avx2") inline void ChaChaQuarterRoundAVX2(__m256i& a, __m256i& b, __m256i& c, __m256i& d) noexcept {
+		a = _mm256_add_epi32(a, b); d = ChaChaRotateAVX2(_mm256_xor_si256(d, a), 16);
+		c = _mm256_add_epi32(c, d); b = ChaChaRotateAVX2(_mm256_xor_si256(b, c), 12);
+		a = _mm256_add_epi32(a, b); d = ChaChaRotateAVX2(_mm256_xor_si256(d, a),  8);
+		c = _mm256_add_epi32(c, d); b = ChaChaRotateAVX2(_mm256_xor_si256(b, c),  7);
+	}
+
+	// Eight blocks per iteration; after the in-lane transpose the low half of each register holds blocks 0-3, the high half 4-7.
+	_CRYPTOAES_TARGET("avx2") inline std::size_t ChaCha20XORAVX2(unsigned int(&State)[16], const unsigned char* pIn, std::size_t unSize, unsigned char* pOut) noexcept {
+		std::size_t unOffset = 0;
+
+		for (; unOffset + 512 <= unSize; unOffset += 512) {
+			__m256i X[16];
+			__m256i B[16];
+			for (unsigned char i = 0; i < 16; ++i) {
+				B[i] = _mm256_set1_epi32(static_cast<int>(State[i]));
+			}
+
+			B[12] = _mm256_add_epi32(B[12], _mm256_set_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+
+			for (unsigned char i = 0; i < 16; ++i) {
+				X[i] = B[i];
+			}
+
+			for (unsigned char i = 0; i < 10; ++i) {
+				ChaChaQuarterRoundAVX2(X[0], X[4], X[ 8], X[12]);
+				ChaChaQuarterRoundAVX2(X[1], X[5], X[ 9], X[13]);
+				ChaChaQuarterRoundAVX2(X[2], X[6], X[10], X[14]);
+				ChaChaQuarterRoundAVX2(X[3], X[7], X[11], X[15]);
+				ChaChaQuarterRoundAVX2(X[0], X[5], X[10], X[15]);
+				ChaChaQuarterRoundAVX2(X[1], X[6], X[11], X[12]);
+				ChaChaQuarterRoundAVX2(X[2], X[7], X[ 8], X[13]);
+				ChaChaQuarterRoundAVX2(X[3], X[4], X[ 9], X[14]);
+			}
+
+			for (unsigned char g = 0; g < 4; ++g) {
+				const __m256i a = _mm256_add_epi32(X[4 * g],     B[4 * g]);
+				const __m256i b = _mm256_add_epi32(X[4 * g + 1], B[4 * g + 1]);
+				const __m256i c = _mm256_add_epi32(X[4 * g + 2], B[4 * g + 2]);
+				const __m256i d = _mm256_add_epi32(X[4 * g + 3], B[4 * g + 3]);
+
+				const __m256i ab0 = _mm256_unpacklo_epi32(a, b), ab1 = _mm256_unpackhi_epi32(a, b);
+				const __m256i cd0 = _mm256_unpacklo_epi32(c, d), cd1 = _mm256_unpackhi_epi32(c, d);
+
+				const __m256i K[4] = { _mm256_unpacklo_epi64(ab0, cd0), _mm256_unpackhi_epi64(ab0, cd0), _mm256_unpacklo_epi64(ab1, cd1), _mm256_unpackhi_epi64(ab1, cd1) };
+
+				for (unsigned char j = 0; j < 4; ++j) {
+					const std::size_t unLo = unOffset + 64 * j + 16 * g;
+					const std::size_t unHi = unLo + 256;
+
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(pOut + unLo), _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pIn + unLo)), _mm256_castsi256_si128(K[j])));
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(pOut + unHi), _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pIn + unHi)), _mm256_extracti128_si256(K[j], 1)));
+				}
+			}
+
+			State[12] += 8;
+		}
+
+		_mm256_zeroupper();
+
+		return unOffset;
+	}
+#endif
+
+	// XORs unSize bytes with the keystream that starts at block State[12], using the widest SIMD path available.
+	inline void ChaCha20XOR(const unsigned int(&State)[16], const unsigned char* pIn, std::size_t unSize, unsigned char* pOut) noexcept {
+		unsigned int S[16] {};
+		for (unsigned char i = 0; i < 16; ++i) {
+			S[i] = State[i];
+		}
+
+		std::size_t unDone = 0;
+
+#ifdef _CRYPTOAES_X86
+		if (GetCPUFeatures().m_bAVX2) {
+			unDone += ChaCha20XORAVX2(S, pIn, unSize, pOut);
+		}
+
+		if (GetCPUFeatures().m_bSSE2) {
+			unDone += ChaCha20XORSSE2(S, pIn + unDone, unSize - unDone, pOut + unDone);
+		}
+#endif
+
+		if (unDone < unSize) {
+			ChaCha20XORPortable(S, pIn + unDone, unSize - unDone, pOut + unDone);
+		}
+
+		SecureWipe(S, sizeof(S));
+	}
+
+	// Same single-pass structure as GCMDecryptAndHash: each chunk is authenticated and then decrypted while still in L1.
+	inline bool ChaChaPolyDecrypt(const unsigned char* pCipherText, std::size_t unCipherTextSize, const unsigned char* pAAD, std::size_t unAADSize, const block16& tag, const ChaChaPrecomputed& pre, const iv12& nonce, unsigned char* pPlainText, std::size_t unTagSize = 16) noexcept {
+		constexpr std::size_t kChunk = 512;
+
+		Poly1305 mac(pre.m_PolyKey);
+		mac.UpdatePadded(pAAD, unAADSize);
+
+		unsigned int State[16] {};
+		ChaChaSetup(pre.m_Key, nonce, 1, State);
+
+		for (std::size_t unOffset = 0; unOffset < unCipherTextSize; unOffset += kChunk) {
+			const std::size_t unChunk = (unOffset + kChunk <= unCipherTextSize) ? kChunk : (unCipherTextSize - unOffset);
+
+			mac.UpdatePadded(pCipherText + unOffset, unChunk);
+			ChaCha20XOR(State, pCipherText + unOffset, unChunk, pPlainText + unOffset);
+
+			State[12] += static_cast<unsigned int>(kChunk / 64);
+		}
+
+		mac.UpdateLengths(unAADSize, unCipherTextSize);
+
+		const bool bValid = compare_block16_ct(mac.Finish(), tag, unTagSize) == 0;
+
+		SecureWipe(State, sizeof(State));
+		SecureWipe(&mac, sizeof(mac));
+
+		return bValid;
+	}
+
+	// ChaCha20-Poly1305 counterpart of GCMOpen, taking the same GCMBlob with the 12-byte nonce in place of the IV.
+	_CRYPTOAES_ENGINE bool ChaChaOpen(const GCMBlob& blob, block32& key, unsigned char* pPlainText) noexcept {
+		iv12 nonce {};
+		for (unsigned char i = 0; i < 12; ++i) {
+			nonce[i] = blob.m_pIV[i];
+		}
+
+		block16 tag {};
+		for (std::size_t i = 0; i < blob.m_unTagSize; ++i) {
+			tag[i] = blob.m_pTag[i];
+		}
+
+		ChaChaPrecomputed pre(key, nonce);
+
+		const bool bValid = ChaChaPolyDecrypt(blob.m_pCipherText, blob.m_unCipherTextSize, kAAD, kAADSize, tag, pre, nonce, pPlainText, blob.m_unTagSize);
+
+		SecureWipe(&pre, sizeof(pre));
+		SecureWipe(&key, sizeof(key));
+
+		if (!bValid) {
+			SecureWipe(pPlainText, blob.m_unCipherTextSize);
+		}
+
+		return bValid;
+	}
+
+	// Unmasks a ChaChaPrecomputed stored by MakeBlob; the mask is wiped afterwards.
+	_CRYPTOAES_ENGINE void ChaChaLoad(const unsigned char* pPrecomputed, Bytes<64>& mask, ChaChaPrecomputed& pre) noexcept {
+		pre.Load(pPrecomputed, mask);
+
+		SecureWipe(&mask, sizeof(mask));
+	}
+
+	_CRYPTOAES_ENGINE void ChaChaPrepare(const block32& key, const iv12& nonce, ChaChaPrecomputed& pre) noexcept {
+		pre = ChaChaPrecomputed(key, nonce);
+	}
+
+	_CRYPTOAES_ENGINE bool ChaChaOpen(const GCMBlob& blob, const unsigned char* pPrecomputed, Bytes<64>& mask, unsigned char* pPlainText) noexcept {
+		ChaChaPrecomputed pre {};
+		ChaChaLoad(pPrecomputed, mask, pre);
+
+		iv12 nonce {};
+		for (unsigned char i = 0; i < 12; ++i) {
+			nonce[i] = blob.m_pIV[i];
+		}
+
+		block16 tag {};
+		for (std::size_t i = 0; i < blob.m_unTagSize; ++i) {
+			tag[i] = blob.m_pTag[i];
+		}
+
+		const bool bValid = ChaChaPolyDecrypt(blob.m_pCipherText, blob.m_unCipherTextSize, kAAD, kAADSize, tag, pre, nonce, pPlainText, blob.m_unTagSize);
+
+		SecureWipe(&pre, sizeof(pre));
+
+		if (!bValid) {
+			SecureWipe(pPlainText, blob.m_unCipherTextSize);
+		}
+
+		return bValid;
+	}
+
+	// Authenticates without producing any plaintext; only Poly1305 runs over the ciphertext.
+	_CRYPTOAES_ENGINE bool ChaChaVerify(const unsigned char* pCipherText, std::size_t unCipherTextSize, const unsigned char* pAAD, std::size_t unAADSize, const block16& tag, const ChaChaPrecomputed& pre, std::size_t unTagSize = 16) noexcept {
+		Poly1305 mac(pre.m_PolyKey);
+		mac.UpdatePadded(pAAD, unAADSize);
+		mac.UpdatePadded(pCipherText, unCipherTextSize);
+		mac.UpdateLengths(unAADSize, unCipherTextSize);
+
+		const bool bValid = compare_block16_ct(mac.Finish(), tag, unTagSize) == 0;
+
+		SecureWipe(&mac, sizeof(mac));
+
+		return bValid;
+	}
+
+	// Decrypts unSize bytes starting at byte offset unOffset; ChaCha20 seeks by setting the block counter directly.
+	_CRYPTOAES_ENGINE void ChaChaDecryptRange(const ChaChaPrecomputed& pre, const iv12& nonce, const unsigned char* pCipherText, std::size_t unOffset, std::size_t unSize, unsigned char* pOut) noexcept {
+		if (unSize == 0) {
+			return;
+		}
+
+		unsigned int State[16] {};
+		ChaChaSetup(pre.m_Key, nonce, 1 + static_cast<unsigned int>(unOffset >> 6), State);
+
+		const std::size_t unHead = unOffset & 63;
+		if (unHead != 0) {
+			unsigned char keystream[64] {};
+			ChaCha20Block(State, keystream);
+			++State[12];
+
+			const std::size_t unTaken = (unSize < 64 - unHead) ? unSize : (64 - unHead);
+			for (std::size_t i = 0; i < unTaken; ++i) {
+				pOut[i] = static_cast<unsigned char>(pCipherText[unOffset + i] ^ keystream[unHead + i]);
+			}
+
+			SecureWipe(keystream, sizeof(keystream));
+
+			unOffset += unTaken;
+			unSize -= unTaken;
+			pOut += unTaken;
+		}
+
+		if (unSize > 0) {
+			ChaCha20XOR(State, pCipherText + unOffset, unSize, pOut);
+		}
+
+		SecureWipe(State, sizeof(State));
+	}
+
+	// ----------------------------------------------------------------
+	// Cipher selection
+	// ----------------------------------------------------------------
+
+	// Blob format of a site: key length, how many tag bytes are kept, and whether the IV is stored or re-derived from
+	// unLine/unCounter at runtime. FullProfile is the historical layout; CompactProfile trades strength for 20 fewer
+	// bytes per blob and AES-128's 10 rounds, meant for bulk UI literals rather than secrets.
+	template<std::size_t unKeyBits = 256, std::size_t unTagSize = 16, bool bStoredIV = true>
+	struct AEADProfile {
+		static_assert((unKeyBits == 128) || (unKeyBits == 256), "Supported key sizes: 128/256 bits");
+		static_assert((unTagSize == 8) || (unTagSize == 12) || (unTagSize == 16), "Supported tag sizes: 8/12/16 bytes");
+
+		static constexpr std::size_t kKeyBytes = unKeyBits / 8;
+		static constexpr std::size_t kTagSize = unTagSize;
+		static constexpr std::size_t kIVSize = bStoredIV ? 12 : 0;
+		static constexpr bool kStoredIV = bStoredIV;
+	};
+
+	using FullProfile = AEADProfile<256, 16, true>;
+	using CompactProfile = AEADProfile<128, 8, false>;
+
+#ifdef CRYPTOAES_COMPACT_PROFILE
+	using DefaultProfile = CompactProfile;
+#else
+	using DefaultProfile = FullProfile;
+#endif
+
+	// What a site class needs from its cipher, so CryptoStringAES/CryptoArrayAES only name Suite<eCipher>.
+	template<Cipher eCipher>
+	struct Suite;
+
+	template<>
+	struct Suite<Cipher::AESGCM> {
+		using Precomputed = GCMPrecomputed;
+
+		template <std::size_t unDataSize, std::size_t unAADSize = 0>
+		static constexpr GCMResult<unDataSize> Encrypt(const unsigned char* pPlainText, const unsigned char* pAAD, const block32& key, const iv12& iv, std::size_t unKeyBytes) noexcept {
+			return GCMEncrypt<unDataSize, unAADSize>(pPlainText, pAAD, key, iv, unKeyBytes);
+		}
+
+		static constexpr Precomputed Precompute(const block32& key, const iv12& iv, std::size_t unKeyBytes) noexcept { return GCMPrecomputed(key, iv, unKeyBytes); }
+
+		static _CRYPTOAES_FORCE_INLINE bool Open(const GCMBlob& blob, block32& key, unsigned char* pPlainText) noexcept { return GCMOpen(blob, key, pPlainText); }
+		static _CRYPTOAES_FORCE_INLINE bool Open(const GCMBlob& blob, const unsigned char* pPrecomputed, Bytes<64>& mask, unsigned char* pPlainText) noexcept { return GCMOpen(blob, pPrecomputed, mask, pPlainText); }
+		static _CRYPTOAES_FORCE_INLINE void Load(const unsigned char* pPrecomputed, Bytes<64>& mask, Precomputed& pre) noexcept { GCMLoad(pPrecomputed, mask, pre); }
+		static _CRYPTOAES_FORCE_INLINE void Prepare(const block32& key, const iv12& iv, Precomputed& pre, std::size_t unKeyBytes) noexcept { GCMPrepare(key, iv, pre, unKeyBytes); }
+
+		static _CRYPTOAES_FORCE_INLINE bool Verify(const unsigned char* pCipherText, std::size_t unCipherTextSize, const unsigned char* pAAD, std::size_t unAADSize, const block16& tag, const Precomputed& pre, std::size_t unTagSize) noexcept {
+			return GCMVerify(pCipherText, unCipherTextSize, pAAD, unAADSize, tag, pre, unTagSize);
+		}
+
+		static _CRYPTOAES_FORCE_INLINE void DecryptRange(const Precomputed& pre, const iv12& iv, const unsigned char* pCipherText, std::size_t unOffset, std::size_t unSize, unsigned char* pOut) noexcept {
+			GCMDecryptRange(pre, iv, pCipherText, unOffset, unSize, pOut);
+		}
+	};
+
+	// RFC 8439 only defines 256-bit keys, so unKeyBytes is always 32 here.
+	template<>
+	struct Suite<Cipher::ChaCha20Poly1305> {
+		using Precomputed = ChaChaPrecomputed;
+
+		template <std::size_t unDataSize, std::size_t unAADSize = 0>
+		static constexpr GCMResult<unDataSize> Encrypt(const unsigned char* pPlainText, const unsigned char* pAAD, const block32& key, const iv12& nonce, std::size_t) noexcept {
+			return ChaChaPolyEncrypt<unDataSize, unAADSize>(pPlainText, pAAD, key, nonce);
+		}
+
+		static constexpr Precomputed Precompute(const block32& key, const iv12& nonce, std::size_t) noexcept { return ChaChaPrecomputed(key, nonce); }
+
+		static _CRYPTOAES_FORCE_INLINE bool Open(const GCMBlob& blob, block32& key, unsigned char* pPlainText) noexcept { return ChaChaOpen(blob, key, pPlainText); }
+		static _CRYPTOAES_FORCE_INLINE bool Open(const GCMBlob& blob, const unsigned char* pPrecomputed, Bytes<64>& mask, unsigned char* pPlainText) noexcept { return ChaChaOpen(blob, pPrecomputed, mask, pPlainText); }
+		static _CRYPTOAES_FORCE_INLINE void Load(const unsigned char* pPrecomputed, Bytes<64>& mask, Precomputed& pre) noexcept { ChaChaLoad(pPrecomputed, mask, pre); }
+		static _CRYPTOAES_FORCE_INLINE void Prepare(const block32& key, const iv12& nonce, Precomputed& pre, std::size_t) noexcept { ChaChaPrepare(key, nonce, pre); }
+
+		static _CRYPTOAES_FORCE_INLINE bool Verify(const unsigned char* pCipherText, std::size_t unCipherTextSize, const unsigned char* pAAD, std::size_t unAADSize, const block16& tag, const Precomputed& pre, std::size_t unTagSize) noexcept {
+			return ChaChaVerify(pCipherText, unCipherTextSize, pAAD, unAADSize, tag, pre, unTagSize);
+		}
+
+		static _CRYPTOAES_FORCE_INLINE void DecryptRange(const Precomputed& pre, const iv12& nonce, const unsigned char* pCipherText, std::size_t unOffset, std::size_t unSize, unsigned char* pOut) noexcept {
+			ChaChaDecryptRange(pre, nonce, pCipherText, unOffset, unSize, pOut);
+		}
+	};
+
+	// ----------------------------------------------------------------
+	// Verification policy
+	// ----------------------------------------------------------------
+
+	// When a site checks its tag. Always verifies on every decrypt; OncePerSite verifies on the first decrypt and then
+	// runs CTR only; Batched never verifies inline and leaves the check to VerifyPending(), so plaintext is handed out
+	// before the tag is known. A failed check is sticky: the site returns zeros from then on.
+	enum class Verification : unsigned char {
+		Always,
+		OncePerSite,
+		Batched
+	};
+
+	using VerificationFailureHook = void (*)(const void* pSite) noexcept;
+
+	inline std::atomic<VerificationFailureHook> g_pVerificationFailureHook { nullptr };
+
+	// Called with the failing site object whatever its policy; nullptr removes the hook.
+	inline void SetVerificationFailureHook(VerificationFailureHook pHook) noexcept {
+		g_pVerificationFailureHook.store(pHook, std::memory_order_release);
+	}
+
+	inline void ReportVerificationFailure(const void* pSite) noexcept {
+		const VerificationFailureHook pHook = g_pVerificationFailureHook.load(std::memory_order_acquire);
+		if (pHook) {
+			pHook(pSite);
+		}
+	}
+
+	// A Batched site waiting for VerifyPending(); queued by its first decrypt.
+	struct VerificationJob {
+		bool (*m_pVerify)(const void* pSite) noexcept;
+		const void* m_pSite;
+		VerificationJob* m_pNext;
+		std::atomic<bool> m_bQueued;
+	};
+
+	inline std::atomic<VerificationJob*> g_pVerificationQueue { nullptr };
+
+	inline void QueueVerification(VerificationJob& job, const void* pSite) noexcept {
+		if (job.m_bQueued.exchange(true, std::memory_order_relaxed)) {
+			return;
+		}
+
+		job.m_pSite = pSite;
+
+		VerificationJob* pHead = g_pVerificationQueue.load(std::memory_order_relaxed);
+		do {
+			job.m_pNext = pHead;
+		} while (!g_pVerificationQueue.compare_exchange_weak(pHead, &job, std::memory_order_release, std::memory_order_relaxed));
+	}
+
+	// Verifies every queued Batched site, e.g. from a background thread after startup; returns how many failed.
+	_CRYPTOAES_ENGINE std::size_t VerifyPending() noexcept {
+		std::size_t unFailed = 0;
+		for (VerificationJob* pJob = g_pVerificationQueue.exchange(nullptr, std::memory_order_acquire); pJob; pJob = pJob->m_pNext) {
+			unFailed += pJob->m_pVerify(pJob->m_pSite) ? 0 : 1;
+		}
+
+		return unFailed;
+	}
+
+	// ----------------------------------------------------------------
+	// Decrypt-once cache
+	// ----------------------------------------------------------------
+
+	// Idle period used by SealIdleCaches() when called without an argument; 0 keeps cached plaintext until SealCaches().
+#ifndef CRYPTOAES_CACHE_IDLE_MS
+#define CRYPTOAES_CACHE_IDLE_MS 0
+#endif
+
+	// Guards the per-site plaintext of the *_CACHED macros. Bit 0 marks the plaintext present, bit 1 a fill or wipe
+	// in progress; the remaining bits count live views, so a seal never wipes storage that is still being read.
+	class CacheGate {
+	private:
+		static constexpr unsigned int kReady = 1;
+		static constexpr unsigned int kBusy = 2;
+		static constexpr unsigned int kReader = 4;
+
+	public:
+		// Fast path is a single CAS; the first caller (or the first after a seal) runs fnFill while the others wait.
+		template<class Fn>
+		_CRYPTOAES_FORCE_INLINE void Acquire(Fn&& fnFill) noexcept {
+			unsigned int unState = m_unState.load(std::memory_order_acquire);
+			for (;;) {
+				if (unState & kBusy) {
+					std::this_thread::yield();
+					unState = m_unState.load(std::memory_order_acquire);
+				} else if (unState & kReady) {
+					if (m_unState.compare_exchange_weak(unState, unState + kReader, std::memory_order_acquire, std::memory_order_acquire)) {
+						return;
+					}
+				} else if (m_unState.compare_exchange_weak(unState, kBusy, std::memory_order_acquire, std::memory_order_acquire)) {
+					fnFill();
+					m_unState.store(kReady + kReader, std::memory_order_release);
+					return;
+				}
+			}
+		}
+
+		_CRYPTOAES_FORCE_INLINE void Release() noexcept {
+			m_bTouched.store(true, std::memory_order_relaxed);
+			m_unState.fetch_sub(kReader, std::memory_order_release);
+		}
+
+		// Wipes only when the plaintext is present and nobody holds a view.
+		template<class Fn>
+		_CRYPTOAES_FORCE_INLINE bool Seal(Fn&& fnWipe) noexcept {
+			unsigned int unState = kReady;
+			if (!m_unState.compare_exchange_strong(unState, kBusy, std::memory_order_acquire, std::memory_order_relaxed)) {
+				return false;
+			}
+
+			fnWipe();
+			m_unState.store(0, std::memory_order_release);
+			return true;
+		}
+
+		// Views only raise a flag; the sweep turns it into a timestamp, so idleness is measured in whole sweep periods.
+		_CRYPTOAES_FORCE_INLINE bool IsIdle(unsigned long long unNow, unsigned long long unIdleMilliseconds) noexcept {
+			if (m_bTouched.exchange(false, std::memory_order_relaxed) || !m_unLastUse) {
+				m_unLastUse = unNow;
+				return false;
+			}
+
+			return (unNow - m_unLastUse) >= unIdleMilliseconds;
+		}
+
+	private:
+		std::atomic<unsigned int> m_unState { 0 };
+		std::atomic<bool> m_bTouched { false };
+		unsigned long long m_unLastUse = 0; // Owned by the sweep (SealIdleCaches is not meant to run concurrently with itself).
+	};
+
+	// Every site that has filled its cache at least once, so SealCaches/SealIdleCaches can reach them.
+	struct CacheEntry {
+		CacheGate* m_pGate;
+		bool (*m_pSeal)() noexcept;
+		CacheEntry* m_pNext;
+		std::atomic<bool> m_bLinked;
+	};
+
+	inline std::atomic<CacheEntry*> g_pCacheHead { nullptr };
+
+	inline void RegisterCache(CacheEntry& entry) noexcept {
+		if (entry.m_bLinked.exchange(true, std::memory_order_relaxed)) {
+			return;
+		}
+
+		CacheEntry* pHead = g_pCacheHead.load(std::memory_order_relaxed);
+		do {
+			entry.m_pNext = pHead;
+		} while (!g_pCacheHead.compare_exchange_weak(pHead, &entry, std::memory_order_release, std::memory_order_relaxed));
+	}
+
+	// Wipes every cached plaintext not currently in use; returns how many were sealed.
+	_CRYPTOAES_ENGINE std::size_t SealCaches() noexcept {
+		std::size_t unSealed = 0;
+		for (CacheEntry* pEntry = g_pCacheHead.load(std::memory_order_acquire); pEntry; pEntry = pEntry->m_pNext) {
+			unSealed += pEntry->m_pSeal() ? 1 : 0;
+		}
+
+		return unSealed;
+	}
+
+	// Same, limited to caches unused since a sweep at least unIdleMilliseconds ago. There is no background thread: call it
+	// periodically from a timer or main loop.
+	_CRYPTOAES_ENGINE std::size_t SealIdleCaches(unsigned long long unIdleMilliseconds = CRYPTOAES_CACHE_IDLE_MS) noexcept {
+		if (!unIdleMilliseconds) {
+			return 0;
+		}
+
+		const unsigned long long unNow = static_cast<unsigned long long>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+
+		std::size_t unSealed = 0;
+		for (CacheEntry* pEntry = g_pCacheHead.load(std::memory_order_acquire); pEntry; pEntry = pEntry->m_pNext) {
+			if (pEntry->m_pGate->IsIdle(unNow, unIdleMilliseconds)) {
+				unSealed += pEntry->m_pSeal() ? 1 : 0;
+			}
+		}
+
+		return unSealed;
+	}
+
+} // namespace CryptoAES
+
+#undef _CRYPTOAES_FORCE_INLINE
+#undef _CRYPTOAES_NO_INLINE
+#undef _CRYPTOAES_ENGINE
+#undef _CRYPTOAES_TARGET
+
+#endif // _COMPILECRYPTOAES_H_
@@ -5,11 +5,19 @@
 
 // STL
 #include <type_traits>
+#include <cstring>
+#include <memory>
+#include <new>
 
 // CompileTimeStamp
 #define COMPILETIMESTAMP_USE_64BIT
 #include "CompileTimeStamp.h"
 
+#ifdef CRYPTOREGISTRY
+// CompileCryptoRegistry
+#include "CompileCryptoRegistry.h"
+#endif
+
 // ----------------------------------------------------------------
 // General definitions
 // ----------------------------------------------------------------
@@ -25,6 +33,24 @@
 #define _CRYPTOARRAY_FORCE_INLINE inline
 #endif
 
+// Runtime XOR width follows the compiler's target flags (-mavx2, /arch:AVX2); define CRYPTOARRAY_NO_SIMD for the 64-bit scalar path only.
+#if !defined(CRYPTOARRAY_NO_SIMD) && defined(__AVX2__)
+#define _CRYPTOARRAY_AVX2
+#endif
+
+#if !defined(CRYPTOARRAY_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)))
+#define _CRYPTOARRAY_SSE2
+#endif
+
+#if defined(_CRYPTOARRAY_AVX2) || defined(_CRYPTOARRAY_SSE2)
+#include <immintrin.h>
+#endif
+
+// Plaintext bytes are the little-endian image of each element, so on little-endian targets they are written straight into T storage.
+#if defined(_MSC_VER) || (defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__))
+#define _CRYPTOARRAY_LITTLE_ENDIAN
+#endif
+
 // ----------------------------------------------------------------
 // CryptoArray
 // ----------------------------------------------------------------
@@ -154,6 +180,75 @@ namespace CryptoArray {
 		unsigned char m_Data[64] {};
 	};
 
+	// Site keystream: byte j is kBaseKey[j % 32] ^ AdditionalKey[j % 64], so it repeats every 64 bytes.
+	template<unsigned long long unLine, unsigned long long unCounter>
+	class KeystreamTable {
+	public:
+		constexpr KeystreamTable() noexcept {
+			const AdditionalKeyArray<unLine, unCounter> AdditionalKey {};
+
+			for (unsigned char i = 0; i < 64; ++i) {
+				m_Data[i] = static_cast<unsigned char>(kBaseKey[i % sizeof(kBaseKey)] ^ AdditionalKey.m_Data[i]);
+			}
+		}
+
+	public:
+		alignas(64) unsigned char m_Data[64] {};
+	};
+
+	// Computed at compile time, one table per (unLine, unCounter). Internal linkage like kBaseKey: another translation unit
+	// built at a different time has a different table for the same line and counter.
+	template<unsigned long long unLine, unsigned long long unCounter>
+	constexpr static KeystreamTable<unLine, unCounter> kKeystream {};
+
+	// Decryption reads the table through a volatile pointer: with both the ciphertext and the table visible as constants the
+	// optimizer would otherwise fold the plaintext into immediates.
+	template<unsigned long long unLine, unsigned long long unCounter>
+	static const unsigned char* const volatile g_pKeystream = kKeystream<unLine, unCounter>.m_Data;
+
+	// pOut[j] = pIn[j] ^ pKeystream[j % 64] for a 64-byte aligned keystream: a whole period per iteration, then 8 bytes at a time.
+	// Internal linkage: the body follows this TU's target flags, and TUs built with and without -mavx2 must not share one copy.
+	static inline void XORKeystream(const unsigned char* pIn, unsigned char* pOut, std::size_t unSize, const unsigned char* pKeystream) noexcept {
+		std::size_t unOffset = 0;
+
+#if defined(_CRYPTOARRAY_AVX2)
+		const __m256i K0 = _mm256_load_si256(reinterpret_cast<const __m256i*>(pKeystream));
+		const __m256i K1 = _mm256_load_si256(reinterpret_cast<const __m256i*>(pKeystream + 32));
+
+		for (; unOffset + 64 <= unSize; unOffset += 64) {
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(pOut + unOffset), _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(pIn + unOffset)), K0));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(pOut + unOffset + 32), _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(pIn + unOffset + 32)), K1));
+		}
+#elif defined(_CRYPTOARRAY_SSE2)
+		const __m128i K0 = _mm_load_si128(reinterpret_cast<const __m128i*>(pKeystream));
+		const __m128i K1 = _mm_load_si128(reinterpret_cast<const __m128i*>(pKeystream + 16));
+		const __m128i K2 = _mm_load_si128(reinterpret_cast<const __m128i*>(pKeystream + 32));
+		const __m128i K3 = _mm_load_si128(reinterpret_cast<const __m128i*>(pKeystream + 48));
+
+		for (; unOffset + 64 <= unSize; unOffset += 64) {
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pOut + unOffset), _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pIn + unOffset)), K0));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pOut + unOffset + 16), _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pIn + unOffset + 16)), K1));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pOut + unOffset + 32), _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pIn + unOffset + 32)), K2));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pOut + unOffset + 48), _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pIn + unOffset + 48)), K3));
+		}
+#endif
+
+		const std::size_t unWordEnd = unSize & ~static_cast<std::size_t>(7);
+		for (; unOffset < unWordEnd; unOffset += 8) {
+			unsigned long long unX = 0;
+			unsigned long long unKey = 0;
+			std::memcpy(&unX, pIn + unOffset, sizeof(unX));
+			std::memcpy(&unKey, pKeystream + (unOffset % 64), sizeof(unKey));
+
+			unX ^= unKey;
+			std::memcpy(pOut + unOffset, &unX, sizeof(unX));
+		}
+
+		for (; unOffset < unSize; ++unOffset) {
+			pOut[unOffset] = static_cast<unsigned char>(pIn[unOffset] ^ pKeystream[unOffset % 64]);
+		}
+	}
+
 	template<typename T, std::size_t N>
 	struct ByteIO;
 
@@ -229,6 +324,36 @@ namespace CryptoArray {
 		}
 	};
 
+	// Page-aligned storage for DecryptedAllocatedArray, so a decrypted table never shares a page with unrelated data.
+	template<typename T, std::size_t unAlignment = 4096>
+	struct PageAllocator {
+		using value_type = T;
+
+		template<typename U>
+		struct rebind {
+			using other = PageAllocator<U, unAlignment>;
+		};
+
+		constexpr PageAllocator() noexcept = default;
+
+		template<typename U>
+		constexpr PageAllocator(const PageAllocator<U, unAlignment>&) noexcept {}
+
+		T* allocate(std::size_t unCount) {
+			return static_cast<T*>(::operator new(unCount * sizeof(T), std::align_val_t { unAlignment }));
+		}
+
+		void deallocate(T* pData, std::size_t) noexcept {
+			::operator delete(pData, std::align_val_t { unAlignment });
+		}
+
+		template<typename U>
+		constexpr bool operator==(const PageAllocator<U, unAlignment>&) const noexcept { return true; }
+	};
+
+	// Site classes read the TU-local keystream, so they are TU-local too; the registry stores a pointer to their DecryptInto.
+	namespace {
+
 	template <unsigned long long unLength, typename T, unsigned long long unLine = 0, unsigned long long unCounter = 0>
 	class CryptoArray {
 	private:
@@ -236,20 +361,18 @@ namespace CryptoArray {
 		static constexpr std::size_t kPlainBytes = kLength * sizeof(T);
 
 	public:
+		using value_type = T;
+
 		class DecryptedArray {
 		public:
 			_CRYPTOARRAY_FORCE_INLINE explicit DecryptedArray(const CryptoArray& Encrypted) noexcept {
-				AdditionalKeyArray<unLine, unCounter> AdditionalKey {};
+				Encrypted.DecryptInto(m_Buffer);
+			}
 
+			// Copies plaintext that is already available (see CryptoRegistry::Decrypt).
+			_CRYPTOARRAY_FORCE_INLINE explicit DecryptedArray(const T* pPlainText) noexcept {
 				for (std::size_t i = 0; i < kLength; ++i) {
-					unsigned char tmp[sizeof(T)] {};
-
-					for (std::size_t k = 0; k < sizeof(T); ++k) {
-						const std::size_t j = i * sizeof(T) + k;
-						tmp[k] = Encrypted.m_Storage[j] ^ kBaseKey[j % sizeof(kBaseKey)] ^ AdditionalKey.m_Data[j % sizeof(AdditionalKey.m_Data)];
-					}
-
-					m_Buffer[i] = ByteIO<T, sizeof(T)>::from(tmp);
+					m_Buffer[i] = pPlainText[i];
 				}
 			}
 
@@ -306,6 +429,81 @@ namespace CryptoArray {
 			T m_Buffer[kLength] {};
 		};
 
+		// Same contents as DecryptedArray, but the plaintext lives in memory obtained from an allocator
+		// (std::allocator, std::pmr::polymorphic_allocator over an arena, PageAllocator, ...).
+		// Moves transfer ownership of the allocation; the buffer is wiped before it is returned.
+		template<class Allocator>
+		class DecryptedAllocatedArray {
+		private:
+			using AllocatorTraits = typename std::allocator_traits<Allocator>::template rebind_traits<T>;
+			using AllocatorType = typename AllocatorTraits::allocator_type;
+
+		public:
+			_CRYPTOARRAY_FORCE_INLINE DecryptedAllocatedArray(const CryptoArray& Encrypted, const Allocator& alloc) : m_Allocator(alloc) {
+				m_pBuffer = AllocatorTraits::allocate(m_Allocator, kLength);
+
+				Encrypted.DecryptInto(m_pBuffer);
+			}
+
+			_CRYPTOARRAY_FORCE_INLINE ~DecryptedAllocatedArray() noexcept {
+				Release();
+			}
+
+			DecryptedAllocatedArray(const DecryptedAllocatedArray&) = delete;
+			DecryptedAllocatedArray& operator=(const DecryptedAllocatedArray&) = delete;
+
+			_CRYPTOARRAY_FORCE_INLINE DecryptedAllocatedArray(DecryptedAllocatedArray&& other) noexcept : m_Allocator(other.m_Allocator), m_pBuffer(other.m_pBuffer) {
+				other.m_pBuffer = nullptr;
+			}
+
+			_CRYPTOARRAY_FORCE_INLINE DecryptedAllocatedArray& operator=(DecryptedAllocatedArray&& other) noexcept requires std::is_copy_assignable_v<AllocatorType> {
+				if (this != &other) {
+					Release();
+
+					m_Allocator = other.m_Allocator;
+					m_pBuffer = other.m_pBuffer;
+					other.m_pBuffer = nullptr;
+				}
+
+				return *this;
+			}
+
+			// Wipes and frees the plaintext now instead of at scope exit; the array is empty afterwards.
+			_CRYPTOARRAY_FORCE_INLINE void Release() noexcept {
+				if (m_pBuffer) {
+					Clear();
+					AllocatorTraits::deallocate(m_Allocator, m_pBuffer, kLength);
+					m_pBuffer = nullptr;
+				}
+			}
+
+			_CRYPTOARRAY_FORCE_INLINE T* data() noexcept { return m_pBuffer; }
+			_CRYPTOARRAY_FORCE_INLINE const T* data() const noexcept { return m_pBuffer; }
+			_CRYPTOARRAY_FORCE_INLINE std::size_t size() const noexcept { return m_pBuffer ? kLength : 0; }
+
+			_CRYPTOARRAY_FORCE_INLINE T& operator[](std::size_t idx) noexcept { return m_pBuffer[idx]; }
+			_CRYPTOARRAY_FORCE_INLINE const T& operator[](std::size_t idx) const noexcept { return m_pBuffer[idx]; }
+
+			_CRYPTOARRAY_FORCE_INLINE T* begin() noexcept { return m_pBuffer; }
+			_CRYPTOARRAY_FORCE_INLINE T* end() noexcept { return m_pBuffer + size(); }
+			_CRYPTOARRAY_FORCE_INLINE const T* begin() const noexcept { return m_pBuffer; }
+			_CRYPTOARRAY_FORCE_INLINE const T* end() const noexcept { return m_pBuffer + size(); }
+
+			_CRYPTOARRAY_FORCE_INLINE operator T* () noexcept { return data(); }
+			_CRYPTOARRAY_FORCE_INLINE operator const T* () const noexcept { return data(); }
+
+		private:
+			_CRYPTOARRAY_FORCE_INLINE void Clear() noexcept {
+				volatile T* pData = m_pBuffer;
+				for (std::size_t i = 0; i < kLength; ++i) {
+					pData[i] = T {};
+				}
+			}
+
+			AllocatorType m_Allocator;
+			T* m_pBuffer = nullptr;
+		};
+
 		_CRYPTOARRAY_FORCE_INLINE constexpr CryptoArray(const T* pData) noexcept {
 			using CT = clean_type<T>;
 			static_assert(std::is_trivially_copyable_v<CT>, "T must be trivially copyable");
@@ -329,6 +527,45 @@ namespace CryptoArray {
 			return DecryptedArray(*this);
 		}
 
+		// Writes the kLength decrypted elements to pOut.
+		_CRYPTOARRAY_FORCE_INLINE bool DecryptInto(T* pOut) const noexcept {
+			unsigned char* pBytes = reinterpret_cast<unsigned char*>(pOut);
+			XORKeystream(m_Storage, pBytes, kPlainBytes, g_pKeystream<unLine, unCounter>);
+
+#ifndef _CRYPTOARRAY_LITTLE_ENDIAN
+			// Rebuild element i in place from the little-endian bytes occupying its own storage.
+			if constexpr (sizeof(T) > 1) {
+				for (std::size_t i = 0; i < kLength; ++i) {
+					unsigned char bytes[sizeof(T)] {};
+					for (std::size_t j = 0; j < sizeof(T); ++j) {
+						bytes[j] = pBytes[i * sizeof(T) + j];
+					}
+
+					pOut[i] = ByteIO<T, sizeof(T)>::from(bytes);
+				}
+			}
+#endif
+
+			return true;
+		}
+
+		// Writes the kLength decrypted elements straight into the caller's buffer, which holds unCapacity elements; returns the number
+		// written, or 0 (buffer untouched) when it is too small.
+		_CRYPTOARRAY_FORCE_INLINE std::size_t DecryptTo(T* pDst, std::size_t unCapacity) const noexcept {
+			if (!pDst || (unCapacity < kLength)) {
+				return 0;
+			}
+
+			return DecryptInto(pDst) ? kLength : 0;
+		}
+
+		static constexpr std::size_t size() noexcept { return kLength; }
+
+		template<class Allocator = std::allocator<T>>
+		_CRYPTOARRAY_FORCE_INLINE DecryptedAllocatedArray<Allocator> DecryptAllocated(const Allocator& alloc = Allocator()) const {
+			return DecryptedAllocatedArray<Allocator>(*this, alloc);
+		}
+
 	private:
 		unsigned char m_Storage[kPlainBytes] {};
 	};
@@ -337,17 +574,48 @@ namespace CryptoArray {
 	_CRYPTOARRAY_FORCE_INLINE constexpr auto MakeCryptoArray(const T(&arr)[N]) noexcept {
 		return CryptoArray<N, T, unLine, unCounter>(arr);
 	}
+
+	} // namespace
 }
 
+#ifdef CRYPTOREGISTRY
+#define _CRYPTOARRAY(ARRAY)                                                                           \
+	([]() -> auto {                                                                                   \
+		static constexpr auto Encrypted = CryptoArray::MakeCryptoArray<__LINE__, __COUNTER__>(ARRAY); \
+		_CRYPTOREGISTRY_SITE(Encrypted, CryptoRegistry::Kind::Array);                                 \
+		return CryptoRegistry::Decrypt(Encrypted, RegistryEntry);                                     \
+	} ())
+#else
 #define _CRYPTOARRAY(ARRAY)                                                                    \
 	([]() -> auto {                                                                            \
 		constexpr auto Encrypted = CryptoArray::MakeCryptoArray<__LINE__, __COUNTER__>(ARRAY); \
 		return Encrypted.Decrypt();                                                            \
 	} ())
+#endif
 
 #define CRYPTOARRAY(ARRAY) _CRYPTOARRAY(ARRAY)
 
+#define _CRYPTOARRAY_TO(ARRAY, DST, CAP)                                                       \
+	([&]() -> std::size_t {                                                                    \
+		constexpr auto Encrypted = CryptoArray::MakeCryptoArray<__LINE__, __COUNTER__>(ARRAY); \
+		return Encrypted.DecryptTo((DST), (CAP));                                              \
+	} ())
+
+#define CRYPTOARRAY_TO(ARRAY, DST, CAP) _CRYPTOARRAY_TO(ARRAY, DST, CAP)
+
+#define _CRYPTOARRAY_ALLOCATED(ARRAY, ALLOCATOR)                                               \
+	([&]() -> auto {                                                                           \
+		constexpr auto Encrypted = CryptoArray::MakeCryptoArray<__LINE__, __COUNTER__>(ARRAY); \
+		return Encrypted.DecryptAllocated(ALLOCATOR);                                          \
+	} ())
+
+#define CRYPTOARRAY_ALLOCATED(ARRAY, ALLOCATOR) _CRYPTOARRAY_ALLOCATED(ARRAY, ALLOCATOR)
+#define CRYPTOARRAY_HEAP(ARRAY) _CRYPTOARRAY_ALLOCATED(ARRAY, std::allocator<std::remove_cv_t<std::remove_extent_t<decltype(ARRAY)>>>())
+
 #undef _CRYPTOARRAY_FORCE_INLINE
 #undef _CRYPTOARRAY_NO_INLINE
+#undef _CRYPTOARRAY_AVX2
+#undef _CRYPTOARRAY_SSE2
+#undef _CRYPTOARRAY_LITTLE_ENDIAN
 
 #endif // !_COMPILECRYPTOARRAY_H_
@@ -5,11 +5,24 @@
 
 // STL
 #include <type_traits>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <new>
+#include <thread>
 
 // CompileTimeStamp
 #define COMPILETIMESTAMP_USE_64BIT
 #include "CompileTimeStamp.h"
 
+// CompileCryptoAES
+#include "CompileCryptoAES.h"
+
+#ifdef CRYPTOREGISTRY
+// CompileCryptoRegistry
+#include "CompileCryptoRegistry.h"
+#endif
+
 // ----------------------------------------------------------------
 // General definitions
 // ----------------------------------------------------------------
@@ -25,402 +38,25 @@
 #define _CRYPTOARRAYAES_FORCE_INLINE inline
 #endif
 
+#ifndef CRYPTOARRAYAES_STREAM_CHUNK
+#define CRYPTOARRAYAES_STREAM_CHUNK 4096
+#endif
+
+#ifndef CRYPTOARRAYAES_SEGMENT_SIZE
+#define CRYPTOARRAYAES_SEGMENT_SIZE 65536
+#endif
+
 // ----------------------------------------------------------------
 // CryptoArrayAES
 // ----------------------------------------------------------------
 
 namespace CryptoArrayAES {
 
+	using namespace CryptoAES;
+
 	template<class T>
 	using clean_type = std::remove_const_t<std::remove_reference_t<T>>;
 
-	template<std::size_t N>
-	struct Bytes {
-		_CRYPTOARRAYAES_FORCE_INLINE constexpr unsigned char* data() noexcept { return m_Data; }
-		_CRYPTOARRAYAES_FORCE_INLINE constexpr const unsigned char* data() const noexcept { return m_Data; }
-		_CRYPTOARRAYAES_FORCE_INLINE constexpr std::size_t size() const noexcept { return N; }
-
-		_CRYPTOARRAYAES_FORCE_INLINE constexpr unsigned char& operator[](std::size_t i) noexcept { return m_Data[i]; }
-		_CRYPTOARRAYAES_FORCE_INLINE constexpr const unsigned char& operator[](std::size_t i) const noexcept { return m_Data[i]; }
-
-		unsigned char m_Data[N] {};
-	};
-
-	using block16 = Bytes<16>;
-	using block32 = Bytes<32>;
-	using iv12 = Bytes<12>;
-
-	constexpr static unsigned char kAAD[10] = { 'R', 'e', 'n', 'a', 'r', 'd', 'D', 'e', 'v', '\0' }; // RenardDev
-	constexpr static std::size_t kAADSize = sizeof(kAAD);
-
-	constexpr static unsigned char kIBS[256] = {
-		0x63, 0x7C, 0x77, 0x7B, 0xF2, 0x6B, 0x6F, 0xC5, 0x30, 0x01, 0x67, 0x2B, 0xFE, 0xD7, 0xAB,
-		0x76, 0xCA, 0x82, 0xC9, 0x7D, 0xFA, 0x59, 0x47, 0xF0, 0xAD, 0xD4, 0xA2, 0xAF, 0x9C, 0xA4,
-		0x72, 0xC0, 0xB7, 0xFD, 0x93, 0x26, 0x36, 0x3F, 0xF7, 0xCC, 0x34, 0xA5, 0xE5, 0xF1, 0x71,
-		0xD8, 0x31, 0x15, 0x04, 0xC7, 0x23, 0xC3, 0x18, 0x96, 0x05, 0x9A, 0x07, 0x12, 0x80, 0xE2,
-		0xEB, 0x27, 0xB2, 0x75, 0x09, 0x83, 0x2C, 0x1A, 0x1B, 0x6E, 0x5A, 0xA0, 0x52, 0x3B, 0xD6,
-		0xB3, 0x29, 0xE3, 0x2F, 0x84, 0x53, 0xD1, 0x00, 0xED, 0x20, 0xFC, 0xB1, 0x5B, 0x6A, 0xCB,
-		0xBE, 0x39, 0x4A, 0x4C, 0x58, 0xCF, 0xD0, 0xEF, 0xAA, 0xFB, 0x43, 0x4D, 0x33, 0x85, 0x45,
-		0xF9, 0x02, 0x7F, 0x50, 0x3C, 0x9F, 0xA8, 0x51, 0xA3, 0x40, 0x8F, 0x92, 0x9D, 0x38, 0xF5,
-		0xBC, 0xB6, 0xDA, 0x21, 0x10, 0xFF, 0xF3, 0xD2, 0xCD, 0x0C, 0x13, 0xEC, 0x5F, 0x97, 0x44,
-		0x17, 0xC4, 0xA7, 0x7E, 0x3D, 0x64, 0x5D, 0x19, 0x73, 0x60, 0x81, 0x4F, 0xDC, 0x22, 0x2A,
-		0x90, 0x88, 0x46, 0xEE, 0xB8, 0x14, 0xDE, 0x5E, 0x0B, 0xDB, 0xE0, 0x32, 0x3A, 0x0A, 0x49,
-		0x06, 0x24, 0xC2, 0xD3, 0xAC, 0x62, 0x91, 0x95, 0xE4, 0x79, 0xE7, 0xC8, 0x37, 0x6D, 0x8D,
-		0xD5, 0x4E, 0xA9, 0x6C, 0x56, 0xF4, 0xEA, 0x65, 0x7A, 0xAE, 0x08, 0xBA, 0x78, 0x25, 0x2E,
-		0x1C, 0xA6, 0xB4, 0xC6, 0xE8, 0xDD, 0x74, 0x1F, 0x4B, 0xBD, 0x8B, 0x8A, 0x70, 0x3E, 0xB5,
-		0x66, 0x48, 0x03, 0xF6, 0x0E, 0x61, 0x35, 0x57, 0xB9, 0x86, 0xC1, 0x1D, 0x9E, 0xE1, 0xF8,
-		0x98, 0x11, 0x69, 0xD9, 0x8E, 0x94, 0x9B, 0x1E, 0x87, 0xE9, 0xCE, 0x55, 0x28, 0xDF, 0x8C,
-		0xA1, 0x89, 0x0D, 0xBF, 0xE6, 0x42, 0x68, 0x41, 0x99, 0x2D, 0x0F, 0xB0, 0x54, 0xBB, 0x16
-	};
-
-	constexpr static unsigned int kRCON[15] = {
-		0x00000000, 0x01000000, 0x02000000,
-		0x04000000, 0x08000000, 0x10000000,
-		0x20000000, 0x40000000, 0x80000000,
-		0x1B000000, 0x36000000, 0x6C000000,
-		0xD8000000, 0xAB000000, 0x4D000000
-	};
-
-	class AESState {
-	public:
-		constexpr AESState() noexcept = default;
-		constexpr explicit AESState(const block16& in) noexcept : m_State(in) {}
-
-	public:
-		constexpr void SubBytes() noexcept {
-			for (unsigned char i = 0; i < 16; ++i) {
-				m_State[i] = kIBS[m_State[i]];
-			}
-		}
-
-		constexpr void ShiftRows() noexcept {
-			unsigned char unT = m_State[1]; m_State[1] = m_State[5]; m_State[5] = m_State[9]; m_State[9] = m_State[13]; m_State[13] = unT;
-			unT = m_State[2]; m_State[2] = m_State[10]; m_State[10] = unT; unT = m_State[6]; m_State[6] = m_State[14]; m_State[14] = unT;
-			unT = m_State[3]; m_State[3] = m_State[15]; m_State[15] = m_State[11]; m_State[11] = m_State[7]; m_State[7] = unT;
-		}
-
-		constexpr void MixColumns() noexcept {
-			for (unsigned char c = 0; c < 4; ++c) {
-				const unsigned char i = static_cast<unsigned char>(4 * c);
-
-				const unsigned char a0 = m_State[i];
-				const unsigned char a1 = m_State[i + 1];
-				const unsigned char a2 = m_State[i + 2];
-				const unsigned char a3 = m_State[i + 3];
-
-				m_State[i]     = static_cast<unsigned char>(GFMul(0x02, a0) ^ GFMul(0x03, a1) ^ a2 ^ a3);
-				m_State[i + 1] = static_cast<unsigned char>(a0 ^ GFMul(0x02, a1) ^ GFMul(0x03, a2) ^ a3);
-				m_State[i + 2] = static_cast<unsigned char>(a0 ^ a1 ^ GFMul(0x02, a2) ^ GFMul(0x03, a3));
-				m_State[i + 3] = static_cast<unsigned char>(GFMul(0x03, a0) ^ a1 ^ a2 ^ GFMul(0x02, a3));
-			}
-		}
-
-		constexpr void AddRoundKeyWords(const unsigned int RK[4]) noexcept {
-			for (unsigned char c = 0; c < 4; ++c) {
-				const unsigned int unWord = RK[c];
-
-				m_State[4 * c]     ^= static_cast<unsigned char>((unWord >> 24) & 0xFF);
-				m_State[4 * c + 1] ^= static_cast<unsigned char>((unWord >> 16) & 0xFF);
-				m_State[4 * c + 2] ^= static_cast<unsigned char>((unWord >>  8) & 0xFF);
-				m_State[4 * c + 3] ^= static_cast<unsigned char>( unWord        & 0xFF);
-			}
-		}
-
-	private:
-		constexpr unsigned char GFMul(unsigned char unA, unsigned char unB) noexcept {
-			unsigned char unR = 0;
-			for (unsigned char i = 0; i < 8; ++i) {
-				if (unB & 1) {
-					unR ^= unA;
-				}
-
-				const bool bHi = (unA & 0x80) != 0;
-
-				unA <<= 1;
-
-				if (bHi) {
-					unA ^= 0x1B;
-				}
-
-				unB >>= 1;
-			}
-
-			return unR;
-		}
-
-	public:
-		block16 m_State {};
-	};
-
-	class AES256KeySchedule {
-	public:
-		constexpr AES256KeySchedule() noexcept = default;
-
-		constexpr explicit AES256KeySchedule(const block32& key) noexcept {
-			for (unsigned char i = 0; i < 8; ++i) {
-				m_Words[i] = _be32(&key[4 * i]);
-			}
-
-			for (unsigned char i = 8; i < 60; ++i) {
-				unsigned int unT = m_Words[i - 1];
-
-				if (i % 8 == 0) {
-					const unsigned int unRot = (unT << 8) | (unT >> 24);
-
-					const unsigned int unSub = (static_cast<unsigned int>(kIBS[(unRot >> 24) & 0xFF]) << 24) |
-											   (static_cast<unsigned int>(kIBS[(unRot >> 16) & 0xFF]) << 16) |
-											   (static_cast<unsigned int>(kIBS[(unRot >>  8) & 0xFF]) <<  8) |
-											   (static_cast<unsigned int>(kIBS[ unRot        & 0xFF]));
-
-					unT = unSub ^ kRCON[i / 8];
-
-				} else if (i % 8 == 4) {
-					const unsigned int unSub = (static_cast<unsigned int>(kIBS[(unT >> 24) & 0xFF]) << 24) |
-											   (static_cast<unsigned int>(kIBS[(unT >> 16) & 0xFF]) << 16) |
-											   (static_cast<unsigned int>(kIBS[(unT >>  8) & 0xFF]) <<  8) |
-											   (static_cast<unsigned int>(kIBS[ unT        & 0xFF]));
-
-					unT = unSub;
-				}
-
-				m_Words[i] = m_Words[i - 8] ^ unT;
-			}
-		}
-
-	private:
-		constexpr unsigned int _be32(const unsigned char* pBuffer) noexcept {
-			return (static_cast<unsigned int>(pBuffer[0]) << 24) |
-				   (static_cast<unsigned int>(pBuffer[1]) << 16) |
-				   (static_cast<unsigned int>(pBuffer[2]) <<  8) |
-					static_cast<unsigned int>(pBuffer[3]);
-		}
-
-	public:
-		unsigned int m_Words[60] {};
-	};
-
-	constexpr block16 AES256EncryptBlock(const block16& in, const AES256KeySchedule& ks) noexcept {
-		AESState state(in);
-		state.AddRoundKeyWords(&ks.m_Words[0]);
-
-		for (unsigned char unR = 1; unR <= 13; ++unR) {
-			state.SubBytes();
-			state.ShiftRows();
-			state.MixColumns();
-			state.AddRoundKeyWords(&ks.m_Words[4 * unR]);
-		}
-
-		state.SubBytes();
-		state.ShiftRows();
-		state.AddRoundKeyWords(&ks.m_Words[56]);
-
-		return state.m_State;
-	}
-
-	constexpr block16 GF128MulBE(const block16& X, const block16& Y) noexcept {
-		block16 Z {};
-		block16 V = Y;
-
-		for (unsigned char unBit = 0; unBit < 128; ++unBit) {
-			const unsigned char unBI = static_cast<unsigned char>(unBit / 8);
-			const char nB7 = static_cast<char>(7 - (unBit % 8));
-
-			if (((X[unBI] >> nB7) & 1) != 0) {
-				for (unsigned char i = 0; i < 16; ++i) {
-					Z[i] ^= V[i];
-				}
-			}
-
-			const bool bLSB = (V[15] & 1) != 0;
-
-			for (char j = 15; j > 0; --j) {
-				V[static_cast<unsigned char>(j)] = static_cast<unsigned char>((V[static_cast<unsigned char>(j)] >> 1) | ((V[static_cast<unsigned char>(j - 1)] & 1) << 7));
-			}
-
-			V[0] >>= 1;
-
-			if (bLSB) {
-				V[0] ^= 0xE1;
-			}
-		}
-
-		return Z;
-	}
-
-	constexpr void GHashAccamulate(const block16& H, const unsigned char* pData, std::size_t unDataLength, block16& accumulator) noexcept {
-		const std::size_t unBlocks = (unDataLength + 15) / 16;
-		block16 buffer {};
-
-		for (std::size_t b = 0; b < unBlocks; ++b) {
-			for (unsigned char i = 0; i < 16; ++i) {
-				const std::size_t unIndex = b * 16 + i;
-				buffer[i] = (unIndex < unDataLength) ? pData[unIndex] : 0;
-			}
-
-			for (unsigned char i = 0; i < 16; ++i) {
-				accumulator[i] ^= buffer[i];
-			}
-
-			accumulator = GF128MulBE(accumulator, H);
-		}
-	}
-
-	template <std::size_t unDataSize>
-	struct GCMResult {
-		std::size_t m_CipherTextSize = unDataSize;
-		unsigned char m_CipherText[unDataSize] {};
-		block16 m_Tag {};
-		constexpr GCMResult() noexcept = default;
-	};
-
-	constexpr void inc32_inplace(block16& ctr) noexcept {
-		for (char i = 15; i >= 12; --i) {
-			if (++ctr[static_cast<unsigned char>(i)] != 0) {
-				break;
-			}
-		}
-	}
-
-	template <std::size_t unDataSize, std::size_t unAADSize = 0>
-	constexpr GCMResult<unDataSize> GCMEncrypt(const unsigned char* pPlainText, const unsigned char* pAAD, const block32& key, const iv12& iv) noexcept {
-		GCMResult<unDataSize> out {};
-
-		const block16 zero {};
-		const AES256KeySchedule ks(key);
-		const block16 H = AES256EncryptBlock(zero, ks);
-
-		block16 J0 {};
-		for (unsigned char i = 0; i < 12; ++i) {
-			J0[i] = iv[i];
-		}
-
-		J0[15] = 1;
-
-		block16 ctr = J0;
-		block16 keystream {};
-		std::size_t unOutIndex = 0;
-
-		for (std::size_t unOffset = 0; unOffset < unDataSize; unOffset += 16) {
-			inc32_inplace(ctr);
-			keystream = AES256EncryptBlock(ctr, ks);
-
-			const std::size_t unChunk = (unOffset + 16 <= unDataSize) ? 16 : (unDataSize - unOffset);
-			for (std::size_t i = 0; i < unChunk; ++i) {
-				out.m_CipherText[unOutIndex + i] = static_cast<unsigned char>(pPlainText[unOffset + i] ^ keystream[i]);
-			}
-
-			unOutIndex += unChunk;
-		}
-
-		out.m_CipherTextSize = unOutIndex;
-
-		block16 S {};
-
-		if constexpr (unAADSize > 0) {
-			GHashAccamulate(H, pAAD, unAADSize, S);
-		}
-
-		if (out.m_CipherTextSize) {
-			GHashAccamulate(H, out.m_CipherText, out.m_CipherTextSize, S);
-		}
-
-		block16 lenblock {};
-
-		const unsigned long long unAADBits = static_cast<unsigned long long>(unAADSize) * 8ull;
-		const unsigned long long unCipherBits = static_cast<unsigned long long>(out.m_CipherTextSize) * 8ull;
-
-		for (unsigned char i = 0; i < 8; ++i) {
-			lenblock[i] = static_cast<unsigned char>((unAADBits >> (56 - 8 * i)) & 0xFF);
-		}
-
-		for (unsigned char i = 0; i < 8; ++i) {
-			lenblock[8 + i] = static_cast<unsigned char>((unCipherBits >> (56 - 8 * i)) & 0xFF);
-		}
-
-		for (unsigned char i = 0; i < 16; ++i) {
-			S[i] ^= lenblock[i];
-		}
-
-		S = GF128MulBE(S, H);
-
-		const block16 ENC_J0 = AES256EncryptBlock(J0, ks);
-		for (unsigned char i = 0; i < 16; ++i) {
-			out.m_Tag[i] = static_cast<unsigned char>(ENC_J0[i] ^ S[i]);
-		}
-
-		return out;
-	}
-
-	constexpr int compare_block16_ct(const block16& a, const block16& b) noexcept {
-		unsigned char unDiff = 0;
-		for (unsigned char i = 0; i < 16; ++i) {
-			unDiff |= a[i] ^ b[i];
-		}
-
-		return unDiff;
-	}
-
-	_CRYPTOARRAYAES_FORCE_INLINE bool GCMDecrypt(const unsigned char* pCipherText, std::size_t unCipherTextSize, const unsigned char* pAAD, std::size_t unAADSize, const block16& tag, const block32& key, const iv12& iv, unsigned char* pPlainText) noexcept {
-		const block16 zero {};
-		const AES256KeySchedule ks(key);
-		const block16 H = AES256EncryptBlock(zero, ks);
-
-		block16 J0 {};
-		for (unsigned char i = 0; i < 12; ++i) {
-			J0[i] = iv[i];
-		}
-
-		J0[15] = 1;
-
-		block16 ctr = J0;
-		block16 keysteam {};
-
-		for (std::size_t unOffset = 0; unOffset < unCipherTextSize; unOffset += 16) {
-			inc32_inplace(ctr);
-			keysteam = AES256EncryptBlock(ctr, ks);
-
-			const std::size_t unChunk = (unOffset + 16 <= unCipherTextSize) ? 16 : (unCipherTextSize - unOffset);
-			for (std::size_t i = 0; i < unChunk; ++i) {
-				pPlainText[unOffset + i] = static_cast<unsigned char>(pCipherText[unOffset + i] ^ keysteam[i]);
-			}
-		}
-
-		block16 S {};
-		if (unAADSize > 0) {
-			GHashAccamulate(H, pAAD, unAADSize, S);
-		}
-
-		GHashAccamulate(H, pCipherText, unCipherTextSize, S);
-
-		block16 lenblock {};
-
-		const unsigned long long unAADBits = static_cast<unsigned long long>(unAADSize) * 8ull;
-		const unsigned long long unCipherBits = static_cast<unsigned long long>(unCipherTextSize) * 8ull;
-
-		for (unsigned char i = 0; i < 8; ++i) {
-			lenblock[i] = static_cast<unsigned char>((unAADBits >> (56 - 8 * i)) & 0xFF);
-		}
-
-		for (unsigned char i = 0; i < 8; ++i) {
-			lenblock[8 + i] = static_cast<unsigned char>((unCipherBits >> (56 - 8 * i)) & 0xFF);
-		}
-
-		for (unsigned char i = 0; i < 16; ++i) {
-			S[i] ^= lenblock[i];
-		}
-
-		S = GF128MulBE(S, H);
-
-		const block16 ENC_J0 = AES256EncryptBlock(J0, ks);
-
-		block16 computed_tag {};
-		for (unsigned char i = 0; i < 16; ++i) {
-			computed_tag[i] = static_cast<unsigned char>(ENC_J0[i] ^ S[i]);
-		}
-
-		return compare_block16_ct(computed_tag, tag) == 0;
-	}
-
 	constexpr unsigned int rotl32(unsigned int x, unsigned int n) noexcept {
 		return (x << n) | (x >> (32u - n));
 	}
@@ -542,10 +178,21 @@ namespace CryptoArrayAES {
 	};
 
 	template<unsigned long long unLine, unsigned long long unCounter>
-	constexpr void BuildAESKey(block32& out) noexcept {
-		AdditionalKeyArrayAES<unLine, unCounter> extra {};
+	constexpr static void BuildAESKey(block32& out) noexcept {
+		// The site-specific half is folded at compile time, so each site carries 32 bytes of key material instead of 64.
+		constexpr block32 kSiteKey = [] {
+			AdditionalKeyArrayAES<unLine, unCounter> extra {};
+
+			block32 key {};
+			for (unsigned char i = 0; i < 32; ++i) {
+				key[i] = static_cast<unsigned char>(extra.m_Data[(i * 7) & 63] ^ extra.m_Data[(i * 13 + 5) & 63]);
+			}
+
+			return key;
+		}();
+
 		for (unsigned char i = 0; i < 32; ++i) {
-			out[i] = static_cast<unsigned char>(kBaseKey[i] ^ extra.m_Data[(i * 7) & 63] ^ extra.m_Data[(i * 13 + 5) & 63]);
+			out[i] = static_cast<unsigned char>(kBaseKey[i] ^ kSiteKey[i]);
 		}
 	}
 
@@ -568,6 +215,15 @@ namespace CryptoArrayAES {
 		iv[11] = static_cast<unsigned char>( unY        & 0xFF);
 	}
 
+	template<unsigned long long unLine, unsigned long long unCounter>
+	constexpr static void BuildPrecomputedMask(Bytes<64>& out) noexcept {
+		AdditionalKeyArrayAES<unCounter, unLine> extra {};
+
+		for (unsigned char i = 0; i < 64; ++i) {
+			out[i] = static_cast<unsigned char>(kBaseKey[(i * 11) & 31] ^ extra.m_Data[(i * 29 + 3) & 63]);
+		}
+	}
+
 	template<typename T, std::size_t N>
 	struct ByteIO;
 
@@ -643,16 +299,66 @@ namespace CryptoArrayAES {
 		}
 	};
 
-	template <unsigned long long unLength, typename T, unsigned long long unLine = 0, unsigned long long unCounter = 0>
+	// Page-aligned storage for DecryptedAllocatedArray, so a decrypted table never shares a page with unrelated data.
+	template<typename T, std::size_t unAlignment = 4096>
+	struct PageAllocator {
+		using value_type = T;
+
+		template<typename U>
+		struct rebind {
+			using other = PageAllocator<U, unAlignment>;
+		};
+
+		constexpr PageAllocator() noexcept = default;
+
+		template<typename U>
+		constexpr PageAllocator(const PageAllocator<U, unAlignment>&) noexcept {}
+
+		T* allocate(std::size_t unCount) {
+			return static_cast<T*>(::operator new(unCount * sizeof(T), std::align_val_t { unAlignment }));
+		}
+
+		void deallocate(T* pData, std::size_t) noexcept {
+			::operator delete(pData, std::align_val_t { unAlignment });
+		}
+
+		template<typename U>
+		constexpr bool operator==(const PageAllocator<U, unAlignment>&) const noexcept { return true; }
+	};
+
+	// Site classes read the TU-local key, so they are TU-local too; otherwise the linker keeps one TU's copy of each member.
+	namespace {
+
+	template <unsigned long long unLength, typename T, unsigned long long unLine = 0, unsigned long long unCounter = 0, Cipher eCipher = kDefaultCipher, class Profile = DefaultProfile, Verification eVerification = Verification::Always>
 	class CryptoArrayAES {
 	private:
+		using Engine = Suite<eCipher>;
+
 		static constexpr std::size_t kLength = static_cast<std::size_t>(unLength);
 		static constexpr std::size_t kPlainBytes = kLength * sizeof(T);
+		static constexpr std::size_t kStreamElements = ((CRYPTOARRAYAES_STREAM_CHUNK / sizeof(T)) < kLength) ? (CRYPTOARRAYAES_STREAM_CHUNK / sizeof(T)) : kLength;
 
+		// Stored IV (if the profile keeps one), ciphertext, truncated tag and, with CRYPTOARRAYAES_PRECOMPUTED, the masked key material.
 		struct EncryptedBlob {
-			unsigned char m_IV[12] {};
-			unsigned char m_CipherText[kPlainBytes] {};
-			unsigned char m_Tag[16] {};
+			static constexpr std::size_t kCipherTextOffset = Profile::kIVSize;
+			static constexpr std::size_t kTagOffset = kCipherTextOffset + kPlainBytes;
+			static constexpr std::size_t kPrecomputedOffset = kTagOffset + Profile::kTagSize;
+#ifdef CRYPTOARRAYAES_PRECOMPUTED
+			static constexpr std::size_t kSize = kPrecomputedOffset + Engine::Precomputed::kSize;
+#else
+			static constexpr std::size_t kSize = kPrecomputedOffset;
+#endif
+
+			constexpr unsigned char* IV() noexcept { return m_Data; }
+			constexpr const unsigned char* IV() const noexcept { return m_Data; }
+			constexpr unsigned char* CipherText() noexcept { return m_Data + kCipherTextOffset; }
+			constexpr const unsigned char* CipherText() const noexcept { return m_Data + kCipherTextOffset; }
+			constexpr unsigned char* Tag() noexcept { return m_Data + kTagOffset; }
+			constexpr const unsigned char* Tag() const noexcept { return m_Data + kTagOffset; }
+			constexpr unsigned char* Precomputed() noexcept { return m_Data + kPrecomputedOffset; }
+			constexpr const unsigned char* Precomputed() const noexcept { return m_Data + kPrecomputedOffset; }
+
+			unsigned char m_Data[kSize] {};
 		};
 
 		static constexpr EncryptedBlob MakeBlob(const T* pData) noexcept {
@@ -677,57 +383,49 @@ namespace CryptoArrayAES {
 				}
 			}
 
-			const auto encrypted = GCMEncrypt<kPlainBytes, kAADSize>(plaintext, kAAD, key, iv);
+			const auto encrypted = Engine::template Encrypt<kPlainBytes, kAADSize>(plaintext, kAAD, key, iv, Profile::kKeyBytes);
 
 			EncryptedBlob blob {};
 
-			for (unsigned char i = 0; i < 12; ++i) {
-				blob.m_IV[i] = iv[i];
+			if constexpr (Profile::kStoredIV) {
+				for (unsigned char i = 0; i < 12; ++i) {
+					blob.IV()[i] = iv[i];
+				}
 			}
 
 			for (std::size_t i = 0; i < kPlainBytes; ++i) {
-				blob.m_CipherText[i] = encrypted.m_CipherText[i];
+				blob.CipherText()[i] = encrypted.m_CipherText[i];
 			}
 
-			for (unsigned char i = 0; i < 16; ++i) {
-				blob.m_Tag[i] = encrypted.m_Tag[i];
+			for (std::size_t i = 0; i < Profile::kTagSize; ++i) {
+				blob.Tag()[i] = encrypted.m_Tag[i];
 			}
 
+#ifdef CRYPTOARRAYAES_PRECOMPUTED
+			Bytes<64> mask {};
+			BuildPrecomputedMask<unLine, unCounter>(mask);
+
+			Engine::Precompute(key, iv, Profile::kKeyBytes).Store(blob.Precomputed(), mask);
+#endif
+
 			return blob;
 		}
 
 		static constexpr EncryptedBlob kBlobFrom(const T* pData) noexcept { return MakeBlob(pData); }
 
 	public:
+		using value_type = T;
+
 		class DecryptedArray {
 		public:
 			_CRYPTOARRAYAES_FORCE_INLINE explicit DecryptedArray(const CryptoArrayAES& self) noexcept {
-				block32 key {};
-				BuildAESKey<unLine, unCounter>(key);
-
-				iv12 iv {};
-				for (unsigned char i = 0; i < 12; ++i) {
-					iv[i] = self.m_EncryptedBlob.m_IV[i];
-				}
-
-				block16 tag {};
-				for (unsigned char i = 0; i < 16; ++i) {
-					tag[i] = self.m_EncryptedBlob.m_Tag[i];
-				}
-
-				unsigned char plaintext[kPlainBytes] {};
-				if (!GCMDecrypt(self.m_EncryptedBlob.m_CipherText, kPlainBytes, kAAD, kAADSize, tag, key, iv, plaintext)) {
-					Clear();
-					return;
-				}
+				self.DecryptInto(m_Buffer);
+			}
 
+			// Copies plaintext that is already available (see CryptoRegistry::Decrypt).
+			_CRYPTOARRAYAES_FORCE_INLINE explicit DecryptedArray(const T* pPlainText) noexcept {
 				for (std::size_t i = 0; i < kLength; ++i) {
-					unsigned char bytes[sizeof(T)] {};
-					for (std::size_t j = 0; j < sizeof(T); ++j) {
-						bytes[j] = plaintext[i * sizeof(T) + j];
-					}
-
-					m_Buffer[i] = ByteIO<T, sizeof(T)>::from(bytes);
+					m_Buffer[i] = pPlainText[i];
 				}
 			}
 
@@ -784,26 +482,838 @@ namespace CryptoArrayAES {
 			T m_Buffer[kLength] {};
 		};
 
-		_CRYPTOARRAYAES_FORCE_INLINE constexpr CryptoArrayAES(const T* pData) noexcept : m_EncryptedBlob(kBlobFrom(pData)) {}
-		_CRYPTOARRAYAES_FORCE_INLINE DecryptedArray Decrypt() const noexcept { return DecryptedArray(*this); }
+		// Same contents as DecryptedArray, but the plaintext lives in memory obtained from an allocator
+		// (std::allocator, std::pmr::polymorphic_allocator over an arena, PageAllocator, ...).
+		// Moves transfer ownership of the allocation; the buffer is wiped before it is returned.
+		template<class Allocator>
+		class DecryptedAllocatedArray {
+		private:
+			using AllocatorTraits = typename std::allocator_traits<Allocator>::template rebind_traits<T>;
+			using AllocatorType = typename AllocatorTraits::allocator_type;
 
-	private:
-		EncryptedBlob m_EncryptedBlob {};
-	};
+		public:
+			_CRYPTOARRAYAES_FORCE_INLINE DecryptedAllocatedArray(const CryptoArrayAES& self, const Allocator& alloc) : m_Allocator(alloc) {
+				m_pBuffer = AllocatorTraits::allocate(m_Allocator, kLength);
 
-	template<unsigned long long unLine, unsigned long long unCounter, typename T, std::size_t N>
-	_CRYPTOARRAYAES_FORCE_INLINE constexpr auto MakeCryptoArray(const T(&arr)[N]) noexcept {
-		return CryptoArrayAES<N, T, unLine, unCounter>(arr);
-	}
-}
+				self.DecryptInto(m_pBuffer);
+			}
 
-#define _CRYPTOARRAYAES(ARRAY)                                                                    \
-	([]() -> auto {                                                                               \
-		constexpr auto Encrypted = CryptoArrayAES::MakeCryptoArray<__LINE__, __COUNTER__>(ARRAY); \
-		return Encrypted.Decrypt();                                                               \
+			_CRYPTOARRAYAES_FORCE_INLINE ~DecryptedAllocatedArray() noexcept {
+				Release();
+			}
+
+			DecryptedAllocatedArray(const DecryptedAllocatedArray&) = delete;
+			DecryptedAllocatedArray& operator=(const DecryptedAllocatedArray&) = delete;
+
+			_CRYPTOARRAYAES_FORCE_INLINE DecryptedAllocatedArray(DecryptedAllocatedArray&& other) noexcept : m_Allocator(other.m_Allocator), m_pBuffer(other.m_pBuffer) {
+				other.m_pBuffer = nullptr;
+			}
+
+			_CRYPTOARRAYAES_FORCE_INLINE DecryptedAllocatedArray& operator=(DecryptedAllocatedArray&& other) noexcept requires std::is_copy_assignable_v<AllocatorType> {
+				if (this != &other) {
+					Release();
+
+					m_Allocator = other.m_Allocator;
+					m_pBuffer = other.m_pBuffer;
+					other.m_pBuffer = nullptr;
+				}
+
+				return *this;
+			}
+
+			// Wipes and frees the plaintext now instead of at scope exit; the array is empty afterwards.
+			_CRYPTOARRAYAES_FORCE_INLINE void Release() noexcept {
+				if (m_pBuffer) {
+					Clear();
+					AllocatorTraits::deallocate(m_Allocator, m_pBuffer, kLength);
+					m_pBuffer = nullptr;
+				}
+			}
+
+			_CRYPTOARRAYAES_FORCE_INLINE T* data() noexcept { return m_pBuffer; }
+			_CRYPTOARRAYAES_FORCE_INLINE const T* data() const noexcept { return m_pBuffer; }
+			_CRYPTOARRAYAES_FORCE_INLINE std::size_t size() const noexcept { return m_pBuffer ? kLength : 0; }
+
+			_CRYPTOARRAYAES_FORCE_INLINE T& operator[](std::size_t idx) noexcept { return m_pBuffer[idx]; }
+			_CRYPTOARRAYAES_FORCE_INLINE const T& operator[](std::size_t idx) const noexcept { return m_pBuffer[idx]; }
+
+			_CRYPTOARRAYAES_FORCE_INLINE T* begin() noexcept { return m_pBuffer; }
+			_CRYPTOARRAYAES_FORCE_INLINE T* end() noexcept { return m_pBuffer + size(); }
+			_CRYPTOARRAYAES_FORCE_INLINE const T* begin() const noexcept { return m_pBuffer; }
+			_CRYPTOARRAYAES_FORCE_INLINE const T* end() const noexcept { return m_pBuffer + size(); }
+
+			_CRYPTOARRAYAES_FORCE_INLINE operator T* () noexcept { return data(); }
+			_CRYPTOARRAYAES_FORCE_INLINE operator const T* () const noexcept { return data(); }
+
+		private:
+			_CRYPTOARRAYAES_FORCE_INLINE void Clear() noexcept {
+				volatile T* p = m_pBuffer;
+				for (std::size_t i = 0; i < kLength; ++i) {
+					p[i] = T {};
+				}
+			}
+
+			AllocatorType m_Allocator;
+			T* m_pBuffer = nullptr;
+		};
+
+		// Random access into the ciphertext: each read decrypts only the keystream blocks covering it.
+		// The tag is checked on first use and the outcome is shared by every view of this site.
+		class DecryptedView {
+		public:
+			_CRYPTOARRAYAES_FORCE_INLINE explicit DecryptedView(const CryptoArrayAES& self) noexcept : m_pSelf(&self) {
+				self.LoadIV(m_IV);
+				self.PrepareKey(m_IV, m_Pre);
+			}
+
+			_CRYPTOARRAYAES_FORCE_INLINE ~DecryptedView() noexcept {
+				SecureWipe(&m_Pre, sizeof(m_Pre));
+			}
+
+			DecryptedView(const DecryptedView&) = delete;
+			DecryptedView& operator=(const DecryptedView&) = delete;
+
+			_CRYPTOARRAYAES_FORCE_INLINE DecryptedView(DecryptedView&& other) noexcept : m_pSelf(other.m_pSelf), m_Pre(other.m_Pre), m_IV(other.m_IV) {
+				SecureWipe(&other.m_Pre, sizeof(other.m_Pre));
+			}
+
+			DecryptedView& operator=(DecryptedView&&) = delete;
+
+			_CRYPTOARRAYAES_FORCE_INLINE bool IsValid() const noexcept {
+				signed char nState = s_nVerified.load(std::memory_order_acquire);
+				if (nState == 0) {
+					block16 tag {};
+					for (std::size_t i = 0; i < Profile::kTagSize; ++i) {
+						tag[i] = m_pSelf->m_EncryptedBlob.Tag()[i];
+					}
+
+					nState = Engine::Verify(m_pSelf->m_EncryptedBlob.CipherText(), kPlainBytes, kAAD, kAADSize, tag, m_Pre, Profile::kTagSize) ? 1 : -1;
+					s_nVerified.store(nState, std::memory_order_release);
+
+					if (nState < 0) {
+						ReportVerificationFailure(m_pSelf);
+					}
+				}
+
+				return nState > 0;
+			}
+
+			// Returns T {} for out-of-range indices or a blob that failed authentication.
+			_CRYPTOARRAYAES_FORCE_INLINE T At(std::size_t unIndex) const noexcept {
+				if ((unIndex >= kLength) || !IsValid()) {
+					return T {};
+				}
+
+				unsigned char bytes[sizeof(T)] {};
+				Engine::DecryptRange(m_Pre, m_IV, m_pSelf->m_EncryptedBlob.CipherText(), unIndex * sizeof(T), sizeof(T), bytes);
+
+				const T value = ByteIO<T, sizeof(T)>::from(bytes);
+
+				SecureWipe(bytes, sizeof(bytes));
+
+				return value;
+			}
+
+			// Decrypts up to unCount elements starting at unOffset into pOut and returns how many were written.
+			_CRYPTOARRAYAES_FORCE_INLINE std::size_t Slice(std::size_t unOffset, std::size_t unCount, T* pOut) const noexcept {
+				if ((unOffset >= kLength) || !IsValid()) {
+					return 0;
+				}
+
+				if (unCount > kLength - unOffset) {
+					unCount = kLength - unOffset;
+				}
+
+				constexpr std::size_t kChunkElements = (256 / sizeof(T));
+
+				unsigned char chunk[kChunkElements * sizeof(T)] {};
+				for (std::size_t unDone = 0; unDone < unCount;) {
+					const std::size_t unElements = ((unCount - unDone) < kChunkElements) ? (unCount - unDone) : kChunkElements;
+
+					Engine::DecryptRange(m_Pre, m_IV, m_pSelf->m_EncryptedBlob.CipherText(), (unOffset + unDone) * sizeof(T), unElements * sizeof(T), chunk);
+
+					for (std::size_t i = 0; i < unElements; ++i) {
+						unsigned char bytes[sizeof(T)] {};
+						for (std::size_t j = 0; j < sizeof(T); ++j) {
+							bytes[j] = chunk[i * sizeof(T) + j];
+						}
+
+						pOut[unDone + i] = ByteIO<T, sizeof(T)>::from(bytes);
+					}
+
+					unDone += unElements;
+				}
+
+				SecureWipe(chunk, sizeof(chunk));
+
+				return unCount;
+			}
+
+			_CRYPTOARRAYAES_FORCE_INLINE T operator[](std::size_t idx) const noexcept { return At(idx); }
+			_CRYPTOARRAYAES_FORCE_INLINE std::size_t size() const noexcept { return kLength; }
+
+		private:
+			const CryptoArrayAES* m_pSelf;
+			typename Engine::Precomputed m_Pre {};
+			iv12 m_IV {};
+		};
+
+		// Handle on the site's decrypt-once plaintext. Every handle shares the same static storage, which stays
+		// readable until the last handle is gone; SealCaches/SealIdleCaches wipe it and the next handle decrypts again.
+		class CachedArray {
+		public:
+			_CRYPTOARRAYAES_FORCE_INLINE explicit CachedArray(const CryptoArrayAES& self) noexcept {
+				s_CacheGate.Acquire([&self]() noexcept {
+					const DecryptedArray plain(self);
+					for (std::size_t i = 0; i < kLength; ++i) {
+						s_Cache[i] = plain[i];
+					}
+
+					RegisterCache(s_CacheEntry);
+				});
+			}
+
+			_CRYPTOARRAYAES_FORCE_INLINE ~CachedArray() noexcept {
+				if (m_bHeld) {
+					s_CacheGate.Release();
+				}
+			}
+
+			CachedArray(const CachedArray&) = delete;
+			CachedArray& operator=(const CachedArray&) = delete;
+
+			_CRYPTOARRAYAES_FORCE_INLINE CachedArray(CachedArray&& other) noexcept : m_bHeld(other.m_bHeld) {
+				other.m_bHeld = false;
+			}
+
+			CachedArray& operator=(CachedArray&&) = delete;
+
+			_CRYPTOARRAYAES_FORCE_INLINE const T* data() const noexcept { return s_Cache; }
+			_CRYPTOARRAYAES_FORCE_INLINE std::size_t size() const noexcept { return kLength; }
+
+			_CRYPTOARRAYAES_FORCE_INLINE const T& operator[](std::size_t idx) const noexcept { return s_Cache[idx]; }
+
+			_CRYPTOARRAYAES_FORCE_INLINE const T* begin() const noexcept { return s_Cache; }
+			_CRYPTOARRAYAES_FORCE_INLINE const T* end() const noexcept { return s_Cache + kLength; }
+
+			_CRYPTOARRAYAES_FORCE_INLINE operator const T* () const noexcept { return data(); }
+
+		private:
+			bool m_bHeld = true;
+		};
+
+		_CRYPTOARRAYAES_FORCE_INLINE constexpr CryptoArrayAES(const T* pData) noexcept : m_EncryptedBlob(kBlobFrom(pData)) {}
+		_CRYPTOARRAYAES_FORCE_INLINE DecryptedArray Decrypt() const noexcept { return DecryptedArray(*this); }
+		_CRYPTOARRAYAES_FORCE_INLINE CachedArray Cached() const noexcept { return CachedArray(*this); }
+
+		// Writes the kLength decrypted elements to pOut; all zero if the tag does not verify.
+		_CRYPTOARRAYAES_FORCE_INLINE bool DecryptInto(T* pOut) const noexcept {
+			// Decrypt in place: element i is rebuilt from the bytes occupying its own storage.
+			unsigned char* pBytes = reinterpret_cast<unsigned char*>(pOut);
+			if (!DecryptBytes(pBytes)) {
+				return false;
+			}
+
+			if constexpr (sizeof(T) > 1) {
+				for (std::size_t i = 0; i < kLength; ++i) {
+					unsigned char bytes[sizeof(T)] {};
+					for (std::size_t j = 0; j < sizeof(T); ++j) {
+						bytes[j] = pBytes[i * sizeof(T) + j];
+					}
+
+					pOut[i] = ByteIO<T, sizeof(T)>::from(bytes);
+				}
+			}
+
+			return true;
+		}
+
+		// Writes the kLength decrypted elements straight into the caller's buffer, which holds unCapacity elements; returns the number
+		// written, or 0 when it is too small (buffer untouched) or the tag does not verify (buffer zeroed).
+		_CRYPTOARRAYAES_FORCE_INLINE std::size_t DecryptTo(T* pDst, std::size_t unCapacity) const noexcept {
+			if (!pDst || (unCapacity < kLength)) {
+				return 0;
+			}
+
+			return DecryptInto(pDst) ? kLength : 0;
+		}
+
+		static constexpr std::size_t size() noexcept { return kLength; }
+
+		template<class Allocator = std::allocator<T>>
+		_CRYPTOARRAYAES_FORCE_INLINE DecryptedAllocatedArray<Allocator> DecryptAllocated(const Allocator& alloc = Allocator()) const { return DecryptedAllocatedArray<Allocator>(*this, alloc); }
+
+		// The view keeps a pointer to this object, so it must outlive the view (see CRYPTOARRAYAES_VIEW).
+		_CRYPTOARRAYAES_FORCE_INLINE DecryptedView View() const noexcept { return DecryptedView(*this); }
+
+		// Decrypts into a fixed stack chunk and hands each one to fnChunk(const T* pData, std::size_t unCount).
+		// Nothing is handed out unless the tag verifies; peak memory is one chunk regardless of kLength.
+		template<class Fn>
+		_CRYPTOARRAYAES_FORCE_INLINE bool Stream(Fn&& fnChunk) const {
+			const DecryptedView view(*this);
+			if (!view.IsValid()) {
+				return false;
+			}
+
+			// The view wipes the key schedule on the way out, also when fnChunk throws; the chunk is wiped here.
+			T chunk[kStreamElements] {};
+			try {
+				for (std::size_t unOffset = 0; unOffset < kLength;) {
+					const std::size_t unCount = view.Slice(unOffset, kStreamElements, chunk);
+
+					fnChunk(static_cast<const T*>(chunk), unCount);
+
+					unOffset += unCount;
+				}
+			} catch (...) {
+				SecureWipe(chunk, sizeof(chunk));
+				throw;
+			}
+
+			SecureWipe(chunk, sizeof(chunk));
+
+			return true;
+		}
+
+		template<class OutputIt>
+		_CRYPTOARRAYAES_FORCE_INLINE bool StreamTo(OutputIt itOut) const {
+			return Stream([&itOut](const T* pData, std::size_t unCount) {
+				for (std::size_t i = 0; i < unCount; ++i) {
+					*itOut++ = pData[i];
+				}
+			});
+		}
+
+	private:
+		// Compact profiles drop the IV from the blob and re-derive it from unLine/unCounter.
+		_CRYPTOARRAYAES_FORCE_INLINE void LoadIV(iv12& iv) const noexcept {
+			if constexpr (Profile::kStoredIV) {
+				for (unsigned char i = 0; i < 12; ++i) {
+					iv[i] = m_EncryptedBlob.IV()[i];
+				}
+			} else {
+				BuildGCMIV<unLine, unCounter>(iv);
+			}
+		}
+
+		_CRYPTOARRAYAES_FORCE_INLINE void PrepareKey(const iv12& iv, typename Engine::Precomputed& pre) const noexcept {
+#ifdef CRYPTOARRAYAES_PRECOMPUTED
+			static_cast<void>(iv);
+
+			Bytes<64> mask {};
+			BuildPrecomputedMask<unLine, unCounter>(mask);
+
+			Engine::Load(m_EncryptedBlob.Precomputed(), mask, pre);
+#else
+			block32 key {};
+			BuildAESKey<unLine, unCounter>(key);
+
+			Engine::Prepare(key, iv, pre, Profile::kKeyBytes);
+
+			SecureWipe(&key, sizeof(key));
+#endif
+		}
+
+		// Verify and decrypt in one pass; everything past building the site key happens out of line in CryptoAES::GCMOpen/ChaChaOpen.
+		_CRYPTOARRAYAES_FORCE_INLINE bool OpenBytes(unsigned char* pPlainText) const noexcept {
+			iv12 iv {};
+			LoadIV(iv);
+
+			const GCMBlob blob { iv.data(), m_EncryptedBlob.CipherText(), kPlainBytes, m_EncryptedBlob.Tag(), Profile::kTagSize, Profile::kKeyBytes };
+
+#ifdef CRYPTOARRAYAES_PRECOMPUTED
+			Bytes<64> mask {};
+			BuildPrecomputedMask<unLine, unCounter>(mask);
+
+			const bool bValid = Engine::Open(blob, m_EncryptedBlob.Precomputed(), mask, pPlainText);
+#else
+			block32 key {};
+			BuildAESKey<unLine, unCounter>(key);
+
+			const bool bValid = Engine::Open(blob, key, pPlainText);
+#endif
+			if (!bValid) {
+				ReportVerificationFailure(this);
+			}
+
+			return bValid;
+		}
+
+		// Keystream only, for sites whose tag is already (or will be) checked elsewhere.
+		_CRYPTOARRAYAES_FORCE_INLINE void DecryptUnverified(unsigned char* pPlainText) const noexcept {
+			iv12 iv {};
+			LoadIV(iv);
+
+			typename Engine::Precomputed pre {};
+			PrepareKey(iv, pre);
+
+			Engine::DecryptRange(pre, iv, m_EncryptedBlob.CipherText(), 0, kPlainBytes, pPlainText);
+
+			SecureWipe(&pre, sizeof(pre));
+		}
+
+		// Runs from VerifyPending() for Batched sites.
+		static bool VerifyQueued(const void* pSite) noexcept {
+			const CryptoArrayAES* pSelf = static_cast<const CryptoArrayAES*>(pSite);
+
+			iv12 iv {};
+			pSelf->LoadIV(iv);
+
+			typename Engine::Precomputed pre {};
+			pSelf->PrepareKey(iv, pre);
+
+			block16 tag {};
+			for (std::size_t i = 0; i < Profile::kTagSize; ++i) {
+				tag[i] = pSelf->m_EncryptedBlob.Tag()[i];
+			}
+
+			const bool bValid = Engine::Verify(pSelf->m_EncryptedBlob.CipherText(), kPlainBytes, kAAD, kAADSize, tag, pre, Profile::kTagSize);
+
+			SecureWipe(&pre, sizeof(pre));
+
+			s_nVerified.store(bValid ? 1 : -1, std::memory_order_release);
+			if (!bValid) {
+				ReportVerificationFailure(pSite);
+			}
+
+			return bValid;
+		}
+
+		// pPlainText is zeroed on failure.
+		_CRYPTOARRAYAES_FORCE_INLINE bool DecryptBytes(unsigned char* pPlainText) const noexcept {
+			if constexpr (eVerification == Verification::Always) {
+				return OpenBytes(pPlainText);
+			} else {
+				const signed char nState = s_nVerified.load(std::memory_order_acquire);
+				if (nState < 0) {
+					SecureWipe(pPlainText, kPlainBytes);
+					return false;
+				}
+
+				if constexpr (eVerification == Verification::OncePerSite) {
+					if (nState == 0) {
+						const bool bValid = OpenBytes(pPlainText);
+						s_nVerified.store(bValid ? 1 : -1, std::memory_order_release);
+						return bValid;
+					}
+				} else if (nState == 0) {
+					QueueVerification(s_VerificationJob, this);
+				}
+
+				DecryptUnverified(pPlainText);
+				return true;
+			}
+		}
+
+		// 0 until the tag has been checked, then 1 or -1; shared by views and, unless eVerification is Always, by Decrypt.
+		static inline std::atomic<signed char> s_nVerified { 0 };
+		// Both are per TU like the class, so one TU's result or queued job never stands in for another TU's site.
+		static inline VerificationJob s_VerificationJob { &VerifyQueued, nullptr, nullptr, {} };
+
+		static bool SealCache() noexcept {
+			return s_CacheGate.Seal([]() noexcept { SecureWipe(s_Cache, sizeof(s_Cache)); });
+		}
+
+		// Decrypted copy for the _CACHED macros; per TU like the class, since __LINE__/__COUNTER__ repeat across TUs.
+		static inline T s_Cache[kLength] {};
+		static inline CacheGate s_CacheGate {};
+		static inline CacheEntry s_CacheEntry { &s_CacheGate, &SealCache, nullptr, {} };
+
+		EncryptedBlob m_EncryptedBlob {};
+	};
+
+	template<unsigned long long unLine, unsigned long long unCounter, Cipher eCipher = kDefaultCipher, class Profile = DefaultProfile, Verification eVerification = Verification::Always, typename T, std::size_t N>
+	_CRYPTOARRAYAES_FORCE_INLINE constexpr auto MakeCryptoArray(const T(&arr)[N]) noexcept {
+		return CryptoArrayAES<N, T, unLine, unCounter, eCipher, Profile, eVerification>(arr);
+	}
+
+	// Segment unSegment is its own GCM message: the site IV with the segment index folded into its last four bytes.
+	constexpr iv12 GCMSegmentIV(const iv12& iv, std::size_t unSegment) noexcept {
+		iv12 out = iv;
+
+		const unsigned int unIndex = static_cast<unsigned int>(unSegment);
+		out[ 8] ^= static_cast<unsigned char>((unIndex >> 24) & 0xFF);
+		out[ 9] ^= static_cast<unsigned char>((unIndex >> 16) & 0xFF);
+		out[10] ^= static_cast<unsigned char>((unIndex >>  8) & 0xFF);
+		out[11] ^= static_cast<unsigned char>( unIndex        & 0xFF);
+
+		return out;
+	}
+
+	// Splits the array into CRYPTOARRAYAES_SEGMENT_SIZE-byte segments, each encrypted and tagged independently,
+	// so segments can be decrypted and verified concurrently and consumed as soon as they are done.
+	template <unsigned long long unLength, typename T, unsigned long long unLine = 0, unsigned long long unCounter = 0>
+	class SegmentedCryptoArrayAES {
+	private:
+		static constexpr std::size_t kLength = static_cast<std::size_t>(unLength);
+		static constexpr std::size_t kPlainBytes = kLength * sizeof(T);
+		static constexpr std::size_t kSegmentElements = (CRYPTOARRAYAES_SEGMENT_SIZE / sizeof(T)) ? (CRYPTOARRAYAES_SEGMENT_SIZE / sizeof(T)) : 1;
+		static constexpr std::size_t kSegmentBytes = kSegmentElements * sizeof(T);
+		static constexpr std::size_t kFullSegments = kLength / kSegmentElements;
+		static constexpr std::size_t kTailBytes = kPlainBytes - kFullSegments * kSegmentBytes;
+		static constexpr std::size_t kSegments = kFullSegments + (kTailBytes ? 1 : 0);
+
+		struct EncryptedBlob {
+			unsigned char m_IV[12] {};
+			unsigned char m_CipherText[kPlainBytes] {};
+			unsigned char m_Tags[kSegments][16] {};
+#ifdef CRYPTOARRAYAES_PRECOMPUTED
+			unsigned char m_Precomputed[GCMPrecomputed::kSize] {};
+#endif
+		};
+
+		template<std::size_t unSegmentBytes>
+		static constexpr void EncryptSegment(EncryptedBlob& blob, const unsigned char* pPlainText, const block32& key, const iv12& iv, std::size_t unSegment) noexcept {
+			const std::size_t unOffset = unSegment * kSegmentBytes;
+			const auto encrypted = GCMEncrypt<unSegmentBytes, kAADSize>(pPlainText + unOffset, kAAD, key, GCMSegmentIV(iv, unSegment));
+
+			for (std::size_t i = 0; i < unSegmentBytes; ++i) {
+				blob.m_CipherText[unOffset + i] = encrypted.m_CipherText[i];
+			}
+
+			for (unsigned char i = 0; i < 16; ++i) {
+				blob.m_Tags[unSegment][i] = encrypted.m_Tag[i];
+			}
+		}
+
+		static constexpr EncryptedBlob MakeBlob(const T* pData) noexcept {
+			using CT = clean_type<T>;
+			static_assert(std::is_trivially_copyable_v<CT>, "T must be trivially copyable");
+			static_assert(std::is_integral_v<CT> || std::is_enum_v<CT>, "T must be integral or enum");
+			static_assert((sizeof(CT) == 1) || (sizeof(CT) == 2) || (sizeof(CT) == 4) || (sizeof(CT) == 8), "Supported sizes: 1/2/4/8 bytes");
+
+			block32 key {};
+			BuildAESKey<unLine, unCounter>(key);
+
+			iv12 iv {};
+			BuildGCMIV<unLine, unCounter>(iv);
+
+			unsigned char plaintext[kPlainBytes] {};
+			for (std::size_t i = 0; i < kLength; ++i) {
+				unsigned char bytes[sizeof(T)] {};
+				ByteIO<T, sizeof(T)>::to(pData[i], bytes);
+
+				for (std::size_t b = 0; b < sizeof(T); ++b) {
+					plaintext[i * sizeof(T) + b] = bytes[b];
+				}
+			}
+
+			EncryptedBlob blob {};
+
+			for (unsigned char i = 0; i < 12; ++i) {
+				blob.m_IV[i] = iv[i];
+			}
+
+			for (std::size_t unSegment = 0; unSegment < kFullSegments; ++unSegment) {
+				EncryptSegment<kSegmentBytes>(blob, plaintext, key, iv, unSegment);
+			}
+
+			if constexpr (kTailBytes > 0) {
+				EncryptSegment<kTailBytes>(blob, plaintext, key, iv, kFullSegments);
+			}
+
+#ifdef CRYPTOARRAYAES_PRECOMPUTED
+			Bytes<64> mask {};
+			BuildPrecomputedMask<unLine, unCounter>(mask);
+
+			GCMPrecomputed(key, iv).Store(blob.m_Precomputed, mask);
+#endif
+
+			return blob;
+		}
+
+		static constexpr EncryptedBlob kBlobFrom(const T* pData) noexcept { return MakeBlob(pData); }
+
+	public:
+		_CRYPTOARRAYAES_FORCE_INLINE constexpr SegmentedCryptoArrayAES(const T* pData) noexcept : m_EncryptedBlob(kBlobFrom(pData)) {}
+
+		static constexpr std::size_t size() noexcept { return kLength; }
+		static constexpr std::size_t SegmentCount() noexcept { return kSegments; }
+
+		// First element and element count of a segment.
+		static constexpr std::size_t SegmentOffset(std::size_t unSegment) noexcept { return unSegment * kSegmentElements; }
+		static constexpr std::size_t SegmentLength(std::size_t unSegment) noexcept { return (unSegment + 1 < kSegments) ? kSegmentElements : (kLength - unSegment * kSegmentElements); }
+
+		// Decrypts one segment into pOut[SegmentOffset(unSegment)..]; pOut always points at the start of the whole array,
+		// so independent calls (e.g. from a thread pool) can share it. The segment is zeroed, and the failure reported, if its
+		// tag does not verify.
+		_CRYPTOARRAYAES_FORCE_INLINE bool DecryptSegment(std::size_t unSegment, T* pOut) const noexcept {
+			GCMPrecomputed pre {};
+			PrepareKey(pre);
+
+			const bool bValid = DecryptSegment(pre, unSegment, pOut);
+
+			SecureWipe(&pre, sizeof(pre));
+
+			if (!bValid && (unSegment < kSegments)) {
+				ReportVerificationFailure(this);
+			}
+
+			return bValid;
+		}
+
+		// Decrypts every segment on unThreads threads (hardware concurrency when 0). fnReady(unSegment) is called from the
+		// worker that finished a verified segment, so callers can start consuming it before the rest is done.
+		// Returns false, wipes pOut[0..size()) and reports the failure once if any segment fails authentication; if fnReady
+		// or starting a thread throws, pOut is wiped the same way and the exception is rethrown after every started worker
+		// has been joined.
+		template<class Fn> requires std::is_invocable_v<Fn&, std::size_t>
+		bool DecryptParallel(T* pOut, Fn&& fnReady, unsigned int unThreads = 0) const {
+			if (unThreads == 0) {
+				unThreads = std::thread::hardware_concurrency();
+			}
+
+			if (unThreads > kSegments) {
+				unThreads = static_cast<unsigned int>(kSegments);
+			}
+
+			GCMPrecomputed pre {};
+			PrepareKey(pre);
+
+			std::atomic<std::size_t> unNext { 0 };
+			std::atomic<bool> bValid { true };
+			std::atomic<bool> bTampered { false };
+			std::atomic_flag bFailed {};
+			std::exception_ptr pException;
+
+			// Stops every worker and keeps the first exception, which is rethrown on the calling thread once all are joined.
+			const auto Fail = [&](std::exception_ptr pError) noexcept {
+				if (!bFailed.test_and_set(std::memory_order_acq_rel)) {
+					pException = pError;
+				}
+
+				bValid.store(false, std::memory_order_relaxed);
+			};
+
+			const auto Worker = [&]() noexcept {
+				for (std::size_t unSegment = unNext.fetch_add(1, std::memory_order_relaxed); unSegment < kSegments; unSegment = unNext.fetch_add(1, std::memory_order_relaxed)) {
+					if (!bValid.load(std::memory_order_relaxed)) {
+						break;
+					}
+
+					if (!DecryptSegment(pre, unSegment, pOut)) {
+						bTampered.store(true, std::memory_order_relaxed);
+						bValid.store(false, std::memory_order_relaxed);
+						break;
+					}
+
+					try {
+						fnReady(unSegment);
+					} catch (...) {
+						Fail(std::current_exception());
+						break;
+					}
+				}
+			};
+
+			std::unique_ptr<std::thread[]> threads;
+			unsigned int unStarted = 0;
+			try {
+				threads.reset(new std::thread[unThreads]);
+				for (; unStarted + 1 < unThreads; ++unStarted) {
+					threads[unStarted] = std::thread(Worker);
+				}
+			} catch (...) {
+				Fail(std::current_exception());
+			}
+
+			Worker();
+
+			for (unsigned int i = 0; i < unStarted; ++i) {
+				threads[i].join();
+			}
+
+			SecureWipe(&pre, sizeof(pre));
+
+			if (!bValid.load(std::memory_order_relaxed)) {
+				volatile T* p = pOut;
+				for (std::size_t i = 0; i < kLength; ++i) {
+					p[i] = T {};
+				}
+
+				if (bTampered.load(std::memory_order_relaxed)) {
+					ReportVerificationFailure(this);
+				}
+
+				if (pException) {
+					std::rethrow_exception(pException);
+				}
+
+				return false;
+			}
+
+			return true;
+		}
+
+		_CRYPTOARRAYAES_FORCE_INLINE bool DecryptParallel(T* pOut, unsigned int unThreads = 0) const {
+			return DecryptParallel(pOut, [](std::size_t) {}, unThreads);
+		}
+
+	private:
+		_CRYPTOARRAYAES_FORCE_INLINE void PrepareKey(GCMPrecomputed& pre) const noexcept {
+#ifdef CRYPTOARRAYAES_PRECOMPUTED
+			Bytes<64> mask {};
+			BuildPrecomputedMask<unLine, unCounter>(mask);
+
+			GCMLoad(m_EncryptedBlob.m_Precomputed, mask, pre);
+#else
+			block32 key {};
+			BuildAESKey<unLine, unCounter>(key);
+
+			iv12 iv {};
+			for (unsigned char i = 0; i < 12; ++i) {
+				iv[i] = m_EncryptedBlob.m_IV[i];
+			}
+
+			GCMPrepare(key, iv, pre);
+
+			SecureWipe(&key, sizeof(key));
+#endif
+		}
+
+		// Only E(K, J0) differs between segments; the round keys and H are shared.
+		_CRYPTOARRAYAES_FORCE_INLINE bool DecryptSegment(const GCMPrecomputed& base, std::size_t unSegment, T* pOut) const noexcept {
+			if (unSegment >= kSegments) {
+				return false;
+			}
+
+			iv12 iv {};
+			for (unsigned char i = 0; i < 12; ++i) {
+				iv[i] = m_EncryptedBlob.m_IV[i];
+			}
+
+			iv = GCMSegmentIV(iv, unSegment);
+
+			GCMPrecomputed pre = base;
+
+			block16 J0 = GCMMakeJ0(iv);
+			AESECB(pre.m_RoundKeys, &J0, 1);
+			pre.m_EncJ0 = J0;
+
+			block16 tag {};
+			for (unsigned char i = 0; i < 16; ++i) {
+				tag[i] = m_EncryptedBlob.m_Tags[unSegment][i];
+			}
+
+			const std::size_t unOffset = SegmentOffset(unSegment);
+			const std::size_t unCount = SegmentLength(unSegment);
+
+			// Decrypt in place: element i is rebuilt from the bytes occupying its own storage.
+			T* pSegment = pOut + unOffset;
+			unsigned char* pBytes = reinterpret_cast<unsigned char*>(pSegment);
+
+			const bool bValid = GCMDecrypt(m_EncryptedBlob.m_CipherText + unOffset * sizeof(T), unCount * sizeof(T), kAAD, kAADSize, tag, pre, iv, pBytes);
+
+			SecureWipe(&pre, sizeof(pre));
+
+			if (!bValid) {
+				volatile T* p = pSegment;
+				for (std::size_t i = 0; i < unCount; ++i) {
+					p[i] = T {};
+				}
+
+				return false;
+			}
+
+			for (std::size_t i = 0; i < unCount; ++i) {
+				unsigned char bytes[sizeof(T)] {};
+				for (std::size_t j = 0; j < sizeof(T); ++j) {
+					bytes[j] = pBytes[i * sizeof(T) + j];
+				}
+
+				pSegment[i] = ByteIO<T, sizeof(T)>::from(bytes);
+			}
+
+			return true;
+		}
+
+		EncryptedBlob m_EncryptedBlob {};
+	};
+
+	template<unsigned long long unLine, unsigned long long unCounter, typename T, std::size_t N>
+	_CRYPTOARRAYAES_FORCE_INLINE constexpr auto MakeSegmentedCryptoArray(const T(&arr)[N]) noexcept {
+		return SegmentedCryptoArrayAES<N, T, unLine, unCounter>(arr);
+	}
+
+	} // namespace
+}
+
+#ifdef CRYPTOREGISTRY
+#define _CRYPTOARRAYAES(ARRAY, CIPHER, PROFILE)                                                                           \
+	([]() -> auto {                                                                                                       \
+		static constexpr auto Encrypted = CryptoArrayAES::MakeCryptoArray<__LINE__, __COUNTER__, CIPHER, PROFILE>(ARRAY); \
+		_CRYPTOREGISTRY_SITE(Encrypted, CryptoRegistry::Kind::ArrayAES);                                                  \
+		return CryptoRegistry::Decrypt(Encrypted, RegistryEntry);                                                         \
+	} ())
+#else
+#define _CRYPTOARRAYAES(ARRAY, CIPHER, PROFILE)                                                                    \
+	([]() -> auto {                                                                                                \
+		constexpr auto Encrypted = CryptoArrayAES::MakeCryptoArray<__LINE__, __COUNTER__, CIPHER, PROFILE>(ARRAY); \
+		return Encrypted.Decrypt();                                                                                \
+	} ())
+#endif
+
+#define CRYPTOARRAYAES(ARRAY) _CRYPTOARRAYAES(ARRAY, CryptoAES::kDefaultCipher, CryptoAES::DefaultProfile)
+#define CRYPTOARRAYAES_CHACHA20(ARRAY) _CRYPTOARRAYAES(ARRAY, CryptoAES::Cipher::ChaCha20Poly1305, CryptoAES::DefaultProfile)
+#define CRYPTOARRAYAES_COMPACT(ARRAY) _CRYPTOARRAYAES(ARRAY, CryptoAES::Cipher::AESGCM, CryptoAES::CompactProfile)
+
+#define _CRYPTOARRAYAES_CACHED(ARRAY, CIPHER, PROFILE)                                                                    \
+	([]() -> auto {                                                                                                       \
+		static constexpr auto Encrypted = CryptoArrayAES::MakeCryptoArray<__LINE__, __COUNTER__, CIPHER, PROFILE>(ARRAY); \
+		return Encrypted.Cached();                                                                                        \
+	} ())
+
+#define CRYPTOARRAYAES_CACHED(ARRAY) _CRYPTOARRAYAES_CACHED(ARRAY, CryptoAES::kDefaultCipher, CryptoAES::DefaultProfile)
+
+#define _CRYPTOARRAYAES_VERIFIED(ARRAY, VERIFICATION)                                                                                                                        \
+	([]() -> auto {                                                                                                                                                          \
+		static constexpr auto Encrypted = CryptoArrayAES::MakeCryptoArray<__LINE__, __COUNTER__, CryptoAES::kDefaultCipher, CryptoAES::DefaultProfile, VERIFICATION>(ARRAY); \
+		return Encrypted.Decrypt();                                                                                                                                          \
+	} ())
+
+#define CRYPTOARRAYAES_VERIFY_ONCE(ARRAY) _CRYPTOARRAYAES_VERIFIED(ARRAY, CryptoAES::Verification::OncePerSite)
+#define CRYPTOARRAYAES_VERIFY_BATCHED(ARRAY) _CRYPTOARRAYAES_VERIFIED(ARRAY, CryptoAES::Verification::Batched)
+
+#define _CRYPTOARRAYAES_VIEW(ARRAY)                                                                      \
+	([]() -> auto {                                                                                      \
+		static constexpr auto Encrypted = CryptoArrayAES::MakeCryptoArray<__LINE__, __COUNTER__>(ARRAY); \
+		return Encrypted.View();                                                                         \
+	} ())
+
+#define CRYPTOARRAYAES_VIEW(ARRAY) _CRYPTOARRAYAES_VIEW(ARRAY)
+
+#define _CRYPTOARRAYAES_STREAM(ARRAY, CALLBACK)                                                          \
+	([&]() -> bool {                                                                                     \
+		static constexpr auto Encrypted = CryptoArrayAES::MakeCryptoArray<__LINE__, __COUNTER__>(ARRAY); \
+		return Encrypted.Stream(CALLBACK);                                                               \
+	} ())
+
+#define CRYPTOARRAYAES_STREAM(ARRAY, CALLBACK) _CRYPTOARRAYAES_STREAM(ARRAY, CALLBACK)
+
+#define _CRYPTOARRAYAES_ALLOCATED(ARRAY, ALLOCATOR)                                               \
+	([&]() -> auto {                                                                              \
+		constexpr auto Encrypted = CryptoArrayAES::MakeCryptoArray<__LINE__, __COUNTER__>(ARRAY); \
+		return Encrypted.DecryptAllocated(ALLOCATOR);                                             \
+	} ())
+
+#define CRYPTOARRAYAES_ALLOCATED(ARRAY, ALLOCATOR) _CRYPTOARRAYAES_ALLOCATED(ARRAY, ALLOCATOR)
+#define CRYPTOARRAYAES_HEAP(ARRAY) _CRYPTOARRAYAES_ALLOCATED(ARRAY, std::allocator<std::remove_cv_t<std::remove_extent_t<decltype(ARRAY)>>>())
+
+#define _CRYPTOARRAYAES_TO(ARRAY, DST, CAP)                                                       \
+	([&]() -> std::size_t {                                                                       \
+		constexpr auto Encrypted = CryptoArrayAES::MakeCryptoArray<__LINE__, __COUNTER__>(ARRAY); \
+		return Encrypted.DecryptTo((DST), (CAP));                                                 \
+	} ())
+
+#define CRYPTOARRAYAES_TO(ARRAY, DST, CAP) _CRYPTOARRAYAES_TO(ARRAY, DST, CAP)
+
+#define _CRYPTOARRAYAES_SEGMENTED(ARRAY)                                                                          \
+	([]() -> const auto& {                                                                                        \
+		static constexpr auto Encrypted = CryptoArrayAES::MakeSegmentedCryptoArray<__LINE__, __COUNTER__>(ARRAY); \
+		return Encrypted;                                                                                         \
 	} ())
 
-#define CRYPTOARRAYAES(ARRAY) _CRYPTOARRAYAES(ARRAY)
+#define CRYPTOARRAYAES_SEGMENTED(ARRAY) _CRYPTOARRAYAES_SEGMENTED(ARRAY)
 
 #undef _CRYPTOARRAYAES_FORCE_INLINE
 #undef _CRYPTOARRAYAES_NO_INLINE
@@ -0,0 +1,454 @@
+// Decrypt cost of CRYPTOSTRINGAES/CRYPTOARRAYAES sites, written out as JSON for release gating.
+//
+// Standalone Linux target (GCC or Clang), not part of CompileUtils.vcxproj:
+//   g++ -std=c++20 -O2 CompileCryptoBenchmark.cpp -o CompileCryptoBenchmark
+//   ./CompileCryptoBenchmark --out results.json
+//
+// Every payload size (1 B to 1 MiB) is measured for string and array sites, AES-GCM on each backend this CPU can run
+// (VAES, AES-NI, table, bitsliced) plus ChaCha20-Poly1305, tag checked on every call or once per site, warm and cold.
+// Build-wide options (CRYPTOSTRINGAES_PRECOMPUTED/CRYPTOARRAYAES_PRECOMPUTED, CRYPTOAES_CONSTANT_TIME, CRYPTOAES_NO_HARDWARE, ...)
+// are passed with -D and recorded in the output.
+
+// STL
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Lets the benchmark force each AES backend in turn.
+#define CRYPTOAES_SELECTABLE_BACKEND
+
+// CompileCryptoStringAES (C++20)
+#include "CompileCryptoStringAES.h"
+
+// CompileCryptoArrayAES (C++20)
+#include "CompileCryptoArrayAES.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define _CRYPTOBENCHMARK_X86
+#endif
+
+#define _CRYPTOBENCHMARK_NO_INLINE __attribute__((noinline))
+
+// ----------------------------------------------------------------
+// Settings
+// ----------------------------------------------------------------
+
+constexpr std::size_t kPayloadSizes[] = { 1, 16, 64, 256, 1024, 4096, 16384, 65536, 262144, 1048576 };
+
+struct Settings {
+	const char* m_pOutput = nullptr;           // --out FILE (stdout otherwise)
+	const char* m_pBackend = nullptr;          // --backend NAME (all available otherwise)
+	std::size_t m_unMaxSize = 1048576;         // --max-size BYTES
+	unsigned long long m_unMinTimeMs = 20;     // --min-time MS, per warm sample
+	unsigned int m_unWarmSamples = 5;          // --warm-samples N
+	unsigned int m_unColdSamples = 15;         // --cold-samples N
+#ifdef _CRYPTOBENCHMARK_X86
+	std::size_t m_unEvictBytes = 0;            // --evict MIB; clflush already covers the site and the output buffer
+#else
+	std::size_t m_unEvictBytes = 64ull << 20;
+#endif
+};
+
+Settings g_Settings;
+
+// ----------------------------------------------------------------
+// Timing
+// ----------------------------------------------------------------
+
+inline unsigned long long NowNs() noexcept {
+	return static_cast<unsigned long long>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// TSC ticks; on other architectures there is no cycle source and cycles/byte is reported as null.
+inline unsigned long long NowCycles() noexcept {
+#ifdef _CRYPTOBENCHMARK_X86
+	_mm_lfence();
+	const unsigned long long unCycles = __rdtsc();
+	_mm_lfence();
+	return unCycles;
+#else
+	return 0;
+#endif
+}
+
+struct Sample {
+	double m_flNs;
+	double m_flCycles;
+};
+
+inline Sample Median(std::vector<Sample>& vecSamples) noexcept {
+	std::sort(vecSamples.begin(), vecSamples.end(), [](const Sample& a, const Sample& b) noexcept { return a.m_flNs < b.m_flNs; });
+	return vecSamples[vecSamples.size() / 2];
+}
+
+// Pushes a range out of every cache level: clflush on x86, plus an optional sweep over a large buffer that also takes out
+// the engine's own tables.
+class Evictor {
+public:
+	explicit Evictor(std::size_t unBytes) : m_vecBuffer(unBytes) {}
+
+	void Flush(const void* pData, std::size_t unSize) noexcept {
+#ifdef _CRYPTOBENCHMARK_X86
+		const unsigned char* pBytes = static_cast<const unsigned char*>(pData);
+		for (std::size_t i = 0; i < unSize; i += 64) {
+			_mm_clflush(pBytes + i);
+		}
+
+		if (unSize) {
+			_mm_clflush(pBytes + unSize - 1);
+		}
+#else
+		static_cast<void>(pData);
+		static_cast<void>(unSize);
+#endif
+	}
+
+	void Sweep() noexcept {
+		for (std::size_t i = 0; i < m_vecBuffer.size(); i += 64) {
+			m_vecBuffer[i] = static_cast<unsigned char>(m_vecBuffer[i] + 1);
+		}
+	}
+
+	void Fence() noexcept {
+#ifdef _CRYPTOBENCHMARK_X86
+		_mm_mfence();
+#endif
+	}
+
+private:
+	std::vector<unsigned char> m_vecBuffer;
+};
+
+// ----------------------------------------------------------------
+// Sites
+// ----------------------------------------------------------------
+
+struct BackendInfo {
+	const char* m_pName;
+	CryptoAES::Backend m_eBackend;
+};
+
+constexpr BackendInfo kBackends[] = {
+	{ "vaes", CryptoAES::Backend::VAES },
+	{ "aes-ni", CryptoAES::Backend::AESNI },
+	{ "table", CryptoAES::Backend::Table },
+	{ "bitsliced", CryptoAES::Backend::Bitsliced }
+};
+
+struct Result {
+	const char* m_pSite;
+	const char* m_pCipher;
+	const char* m_pBackend;
+	const char* m_pVerification;
+	const char* m_pCache;
+	std::size_t m_unBytes;
+	unsigned long long m_unCalls;
+	Sample m_Median;
+};
+
+std::vector<Result> g_vecResults;
+unsigned int g_unFailures = 0;
+
+// Out of line so the measured loop cannot be folded or hoisted by the compiler.
+template<class Site>
+_CRYPTOBENCHMARK_NO_INLINE bool DecryptOnce(const Site& site, typename Site::value_type* pOut) noexcept {
+	return site.DecryptInto(pOut);
+}
+
+template<class Site>
+void MeasureWarm(const Site& site, typename Site::value_type* pOut, Result result) {
+	// Calibrate the batch so one sample runs for at least --min-time.
+	unsigned long long unCalls = 1;
+	for (;;) {
+		const unsigned long long unBegin = NowNs();
+		for (unsigned long long i = 0; i < unCalls; ++i) {
+			DecryptOnce(site, pOut);
+		}
+
+		if ((NowNs() - unBegin) >= (g_Settings.m_unMinTimeMs * 1000000ull)) {
+			break;
+		}
+
+		unCalls *= 2;
+	}
+
+	std::vector<Sample> vecSamples;
+	for (unsigned int unSample = 0; unSample < g_Settings.m_unWarmSamples; ++unSample) {
+		const unsigned long long unBeginNs = NowNs();
+		const unsigned long long unBeginCycles = NowCycles();
+		for (unsigned long long i = 0; i < unCalls; ++i) {
+			DecryptOnce(site, pOut);
+		}
+
+		const unsigned long long unCycles = NowCycles() - unBeginCycles;
+		const unsigned long long unNs = NowNs() - unBeginNs;
+
+		vecSamples.push_back(Sample { static_cast<double>(unNs) / static_cast<double>(unCalls), static_cast<double>(unCycles) / static_cast<double>(unCalls) });
+	}
+
+	result.m_pCache = "warm";
+	result.m_unCalls = unCalls * g_Settings.m_unWarmSamples;
+	result.m_Median = Median(vecSamples);
+	g_vecResults.push_back(result);
+}
+
+template<class Site>
+void MeasureCold(const Site& site, typename Site::value_type* pOut, Evictor& evictor, Result result) {
+	std::vector<Sample> vecSamples;
+	for (unsigned int unSample = 0; unSample < g_Settings.m_unColdSamples; ++unSample) {
+		evictor.Sweep();
+		evictor.Flush(&site, sizeof(Site));
+		evictor.Flush(pOut, Site::size() * sizeof(typename Site::value_type));
+		evictor.Fence();
+
+		const unsigned long long unBeginNs = NowNs();
+		const unsigned long long unBeginCycles = NowCycles();
+
+		DecryptOnce(site, pOut);
+
+		const unsigned long long unCycles = NowCycles() - unBeginCycles;
+		const unsigned long long unNs = NowNs() - unBeginNs;
+
+		vecSamples.push_back(Sample { static_cast<double>(unNs), static_cast<double>(unCycles) });
+	}
+
+	result.m_pCache = "cold";
+	result.m_unCalls = g_Settings.m_unColdSamples;
+	result.m_Median = Median(vecSamples);
+	g_vecResults.push_back(result);
+}
+
+// Encrypts at runtime through the same constexpr path the macros use at compile time: 1 MiB literals are beyond what a
+// compiler will constant-evaluate, and the decrypt side is identical either way.
+template<class Site>
+void MeasureSite(const char* pSite, const char* pCipher, const char* pBackend, const char* pVerification, const std::vector<unsigned char>& vecPlain, Evictor& evictor) {
+	using T = typename Site::value_type;
+
+	std::vector<T> vecInput(Site::size());
+	for (std::size_t i = 0; i < Site::size(); ++i) {
+		vecInput[i] = static_cast<T>(vecPlain[i]);
+	}
+
+	const std::unique_ptr<Site> pEncrypted = std::make_unique<Site>(vecInput.data());
+
+	std::vector<T> vecOutput(Site::size());
+	if (!DecryptOnce(*pEncrypted, vecOutput.data()) || (vecOutput != vecInput)) {
+		std::fprintf(stderr, "%s/%s/%s/%s/%zu: decrypted data does not match\n", pSite, pCipher, pBackend, pVerification, Site::size());
+		++g_unFailures;
+		return;
+	}
+
+	const Result result { pSite, pCipher, pBackend, pVerification, nullptr, Site::size() * sizeof(T), 0, {} };
+
+	MeasureWarm(*pEncrypted, vecOutput.data(), result);
+	MeasureCold(*pEncrypted, vecOutput.data(), evictor, result);
+}
+
+template<std::size_t unSize, CryptoAES::Cipher eCipher, CryptoAES::Verification eVerification>
+void MeasureSites(const char* pCipher, const char* pBackend, const char* pVerification, const std::vector<unsigned char>& vecPlain, Evictor& evictor) {
+	using StringSite = CryptoStringAES::CryptoStringAES<unSize, char, 0, 0, eCipher, CryptoAES::DefaultProfile, eVerification>;
+	using ArraySite = CryptoArrayAES::CryptoArrayAES<unSize, unsigned char, 0, 0, eCipher, CryptoAES::DefaultProfile, eVerification>;
+
+	MeasureSite<StringSite>("CRYPTOSTRINGAES", pCipher, pBackend, pVerification, vecPlain, evictor);
+	MeasureSite<ArraySite>("CRYPTOARRAYAES", pCipher, pBackend, pVerification, vecPlain, evictor);
+}
+
+template<std::size_t unSize>
+void MeasureSize(const std::vector<unsigned char>& vecPlain, Evictor& evictor) {
+	if (unSize > g_Settings.m_unMaxSize) {
+		return;
+	}
+
+	for (const BackendInfo& backend : kBackends) {
+		if ((g_Settings.m_pBackend && std::strcmp(g_Settings.m_pBackend, backend.m_pName)) || !CryptoAES::IsBackendAvailable(backend.m_eBackend)) {
+			continue;
+		}
+
+		std::fprintf(stderr, "%zu bytes, aes-gcm/%s\n", unSize, backend.m_pName);
+
+		CryptoAES::SetBackend(backend.m_eBackend);
+		MeasureSites<unSize, CryptoAES::Cipher::AESGCM, CryptoAES::Verification::Always>("aes-gcm", backend.m_pName, "always", vecPlain, evictor);
+		MeasureSites<unSize, CryptoAES::Cipher::AESGCM, CryptoAES::Verification::OncePerSite>("aes-gcm", backend.m_pName, "once-per-site", vecPlain, evictor);
+	}
+
+	CryptoAES::SetBackend(CryptoAES::Backend::Auto);
+
+	// ChaCha20 has no AES backend; it picks AVX2, SSE2 or portable code on its own.
+	if (!g_Settings.m_pBackend || !std::strcmp(g_Settings.m_pBackend, "chacha20")) {
+		std::fprintf(stderr, "%zu bytes, chacha20-poly1305\n", unSize);
+
+		MeasureSites<unSize, CryptoAES::Cipher::ChaCha20Poly1305, CryptoAES::Verification::Always>("chacha20-poly1305", "chacha20", "always", vecPlain, evictor);
+		MeasureSites<unSize, CryptoAES::Cipher::ChaCha20Poly1305, CryptoAES::Verification::OncePerSite>("chacha20-poly1305", "chacha20", "once-per-site", vecPlain, evictor);
+	}
+}
+
+template<std::size_t... I>
+void MeasureAll(std::index_sequence<I...>, const std::vector<unsigned char>& vecPlain, Evictor& evictor) {
+	(MeasureSize<kPayloadSizes[I]>(vecPlain, evictor), ...);
+}
+
+// ----------------------------------------------------------------
+// Output
+// ----------------------------------------------------------------
+
+// Ticks per nanosecond, so a reader can turn TSC cycles back into time.
+double MeasureTSCRate() noexcept {
+#ifdef _CRYPTOBENCHMARK_X86
+	const unsigned long long unBeginNs = NowNs();
+	const unsigned long long unBeginCycles = NowCycles();
+	while ((NowNs() - unBeginNs) < 50000000ull) {}
+	return static_cast<double>(NowCycles() - unBeginCycles) / static_cast<double>(NowNs() - unBeginNs);
+#else
+	return 0.0;
+#endif
+}
+
+const char* Bool(bool bValue) noexcept {
+	return bValue ? "true" : "false";
+}
+
+void WriteJSON(std::FILE* pFile, double flTSCRate) {
+#ifdef _CRYPTOBENCHMARK_X86
+	constexpr bool bCycles = true;
+#else
+	constexpr bool bCycles = false;
+#endif
+
+#if defined(CRYPTOSTRINGAES_PRECOMPUTED) || defined(CRYPTOARRAYAES_PRECOMPUTED)
+	constexpr bool bPrecomputed = true;
+#else
+	constexpr bool bPrecomputed = false;
+#endif
+
+#if defined(CRYPTOAES_CONSTANT_TIME) || defined(CRYPTOSTRINGAES_CONSTANT_TIME) || defined(CRYPTOARRAYAES_CONSTANT_TIME)
+	constexpr bool bConstantTime = true;
+#else
+	constexpr bool bConstantTime = false;
+#endif
+
+#if defined(CRYPTOAES_NO_HARDWARE) || defined(CRYPTOSTRINGAES_NO_HARDWARE) || defined(CRYPTOARRAYAES_NO_HARDWARE)
+	constexpr bool bNoHardware = true;
+#else
+	constexpr bool bNoHardware = false;
+#endif
+
+#ifdef CRYPTOAES_TABLE_AES
+	constexpr bool bTableAES = true;
+#else
+	constexpr bool bTableAES = false;
+#endif
+
+#ifdef CRYPTOAES_INLINE_ENGINE
+	constexpr bool bInlineEngine = true;
+#else
+	constexpr bool bInlineEngine = false;
+#endif
+
+#if defined(__clang__)
+	const char* pCompiler = "clang " __clang_version__;
+#elif defined(__GNUC__)
+	const char* pCompiler = "gcc " __VERSION__;
+#else
+	const char* pCompiler = "unknown";
+#endif
+
+	std::fprintf(pFile, "{\n");
+	std::fprintf(pFile, "  \"schema\": 1,\n");
+	std::fprintf(pFile, "  \"compiler\": \"%s\",\n", pCompiler);
+	std::fprintf(pFile, "  \"build\": { \"precomputed\": %s, \"constant_time\": %s, \"no_hardware\": %s, \"table_aes\": %s, \"inline_engine\": %s },\n", Bool(bPrecomputed), Bool(bConstantTime), Bool(bNoHardware), Bool(bTableAES), Bool(bInlineEngine));
+	std::fprintf(pFile, "  \"backends\": { \"vaes\": %s, \"aes-ni\": %s, \"table\": true, \"bitsliced\": true },\n", Bool(CryptoAES::IsBackendAvailable(CryptoAES::Backend::VAES)), Bool(CryptoAES::IsBackendAvailable(CryptoAES::Backend::AESNI)));
+	std::fprintf(pFile, "  \"cycle_source\": %s,\n", bCycles ? "\"tsc\"" : "null");
+	std::fprintf(pFile, "  \"tsc_ticks_per_ns\": %.4f,\n", flTSCRate);
+	std::fprintf(pFile, "  \"results\": [");
+
+	for (std::size_t i = 0; i < g_vecResults.size(); ++i) {
+		const Result& result = g_vecResults[i];
+
+		std::fprintf(pFile, "%s\n    { \"site\": \"%s\", \"cipher\": \"%s\", \"backend\": \"%s\", \"verification\": \"%s\", \"cache\": \"%s\", \"bytes\": %zu, \"calls\": %llu, \"ns_per_call\": %.2f, ",
+		             i ? "," : "", result.m_pSite, result.m_pCipher, result.m_pBackend, result.m_pVerification, result.m_pCache, result.m_unBytes, result.m_unCalls, result.m_Median.m_flNs);
+
+		if (bCycles) {
+			std::fprintf(pFile, "\"cycles_per_call\": %.1f, \"cycles_per_byte\": %.3f }", result.m_Median.m_flCycles, result.m_Median.m_flCycles / static_cast<double>(result.m_unBytes));
+		} else {
+			std::fprintf(pFile, "\"cycles_per_call\": null, \"cycles_per_byte\": null }");
+		}
+	}
+
+	std::fprintf(pFile, "\n  ],\n");
+	std::fprintf(pFile, "  \"failures\": %u\n", g_unFailures);
+	std::fprintf(pFile, "}\n");
+}
+
+// ----------------------------------------------------------------
+// Main
+// ----------------------------------------------------------------
+
+bool ParseArguments(int nArgs, char** pArgs) {
+	for (int i = 1; i < nArgs; ++i) {
+		const std::string strArg = pArgs[i];
+		const char* pValue = (i + 1 < nArgs) ? pArgs[i + 1] : nullptr;
+
+		if (!pValue) {
+			return false;
+		}
+
+		if (strArg == "--out") {
+			g_Settings.m_pOutput = pValue;
+		} else if (strArg == "--backend") {
+			g_Settings.m_pBackend = pValue;
+		} else if (strArg == "--max-size") {
+			g_Settings.m_unMaxSize = std::strtoull(pValue, nullptr, 10);
+		} else if (strArg == "--min-time") {
+			g_Settings.m_unMinTimeMs = std::strtoull(pValue, nullptr, 10);
+		} else if (strArg == "--warm-samples") {
+			g_Settings.m_unWarmSamples = static_cast<unsigned int>(std::strtoul(pValue, nullptr, 10));
+		} else if (strArg == "--cold-samples") {
+			g_Settings.m_unColdSamples = static_cast<unsigned int>(std::strtoul(pValue, nullptr, 10));
+		} else if (strArg == "--evict") {
+			g_Settings.m_unEvictBytes = static_cast<std::size_t>(std::strtoull(pValue, nullptr, 10)) << 20;
+		} else {
+			return false;
+		}
+
+		++i;
+	}
+
+	return (g_Settings.m_unWarmSamples > 0) && (g_Settings.m_unColdSamples > 0);
+}
+
+int main(int nArgs, char** pArgs) {
+	if (!ParseArguments(nArgs, pArgs)) {
+		std::fprintf(stderr, "usage: %s [--out FILE] [--backend vaes|aes-ni|table|bitsliced|chacha20] [--max-size BYTES] [--min-time MS] [--warm-samples N] [--cold-samples N] [--evict MIB]\n", pArgs[0]);
+		return 2;
+	}
+
+	std::vector<unsigned char> vecPlain(kPayloadSizes[std::size(kPayloadSizes) - 1]);
+	for (std::size_t i = 0; i < vecPlain.size(); ++i) {
+		vecPlain[i] = static_cast<unsigned char>('A' + (i * 7) % 26);
+	}
+
+	Evictor evictor(g_Settings.m_unEvictBytes);
+
+	MeasureAll(std::make_index_sequence<std::size(kPayloadSizes)>(), vecPlain, evictor);
+
+	std::FILE* pFile = g_Settings.m_pOutput ? std::fopen(g_Settings.m_pOutput, "w") : stdout;
+	if (!pFile) {
+		std::perror(g_Settings.m_pOutput);
+		return 2;
+	}
+
+	WriteJSON(pFile, MeasureTSCRate());
+
+	if (pFile != stdout) {
+		std::fclose(pFile);
+	}
+
+	return g_unFailures ? 1 : 0;
+}
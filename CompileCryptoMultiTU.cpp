@@ -0,0 +1,109 @@
+// Two translation units with encrypted sites on the same lines, for the per-TU keys of the crypto headers.
+//
+// Standalone target (GCC or Clang), not part of CompileUtils.vcxproj. The same file is built twice, a second apart,
+// so both objects get different compile-time keys but identical __LINE__/__COUNTER__ values:
+//   g++ -std=c++20 -O0 -c CompileCryptoMultiTU.cpp -o CompileCryptoMultiTU1.o
+//   sleep 1
+//   g++ -std=c++20 -O0 -DCRYPTOMULTITU_SECOND -c CompileCryptoMultiTU.cpp -o CompileCryptoMultiTU2.o
+//   g++ CompileCryptoMultiTU1.o CompileCryptoMultiTU2.o -o CompileCryptoMultiTU -pthread
+//   ./CompileCryptoMultiTU
+//
+// Any site code the linker shares between the two objects decrypts one of them with the other's key.
+// With -DCRYPTOREGISTRY on all three commands the sites are decrypted through CryptoRegistry::DecryptAll() first.
+
+// STL
+#include <cstdio>
+#include <cstring>
+
+// CompileCryptoString (C++14)
+#include "CompileCryptoString.h"
+
+// CompileCryptoArray (C++20)
+#include "CompileCryptoArray.h"
+
+// CompileCryptoStringAES (C++20)
+#include "CompileCryptoStringAES.h"
+
+// CompileCryptoArrayAES (C++20)
+#include "CompileCryptoArrayAES.h"
+
+#ifdef CRYPTOMULTITU_SECOND
+#define _CRYPTOMULTITU_TEXT "world"
+#define _CRYPTOMULTITU_CHECK CheckSecond
+static constexpr int kArray[] = { 5, 6, 7, 8 };
+static constexpr bool kFirst = false;
+#else
+#define _CRYPTOMULTITU_TEXT "hello"
+#define _CRYPTOMULTITU_CHECK CheckFirst
+static constexpr int kArray[] = { 1, 2, 3, 4 };
+static constexpr bool kFirst = true;
+#endif
+
+template<CryptoAES::Verification eVerification, unsigned long long unLine>
+using VerifiedSite = CryptoStringAES::CryptoStringAES<sizeof(_CRYPTOMULTITU_TEXT), char, unLine, 0, CryptoAES::kDefaultCipher, CryptoAES::DefaultProfile, eVerification>;
+
+// Flips the first tag byte; the blob is the only member of a site and holds the IV, the ciphertext and then the tag.
+template<class Site>
+static void Tamper(Site& site) {
+	reinterpret_cast<unsigned char*>(&site)[CryptoAES::DefaultProfile::kIVSize + sizeof(_CRYPTOMULTITU_TEXT)] ^= 1;
+}
+
+bool _CRYPTOMULTITU_CHECK() {
+	bool bOK = true;
+
+	bOK &= std::strcmp(CRYPTOSTRING(_CRYPTOMULTITU_TEXT), _CRYPTOMULTITU_TEXT) == 0;
+	bOK &= std::memcmp(CRYPTOARRAY(kArray).data(), kArray, sizeof(kArray)) == 0;
+
+	bOK &= std::strcmp(CRYPTOSTRINGAES(_CRYPTOMULTITU_TEXT), _CRYPTOMULTITU_TEXT) == 0;
+	bOK &= std::strcmp(CRYPTOSTRINGAES_CHACHA20(_CRYPTOMULTITU_TEXT), _CRYPTOMULTITU_TEXT) == 0;
+	bOK &= std::strcmp(CRYPTOSTRINGAES_CACHED(_CRYPTOMULTITU_TEXT).c_str(), _CRYPTOMULTITU_TEXT) == 0;
+
+	char szBuffer[16] {};
+	bOK &= (CRYPTOSTRINGAES_TO(_CRYPTOMULTITU_TEXT, szBuffer, sizeof(szBuffer)) == sizeof(_CRYPTOMULTITU_TEXT)) && (std::strcmp(szBuffer, _CRYPTOMULTITU_TEXT) == 0);
+
+	const auto Array = CRYPTOARRAYAES(kArray);
+	bOK &= std::memcmp(Array.data(), kArray, sizeof(kArray)) == 0;
+	bOK &= std::memcmp(CRYPTOARRAYAES_CACHED(kArray).data(), kArray, sizeof(kArray)) == 0;
+
+	int pSegmented[4] {};
+	bOK &= CRYPTOARRAYAES_SEGMENTED(kArray).DecryptParallel(pSegmented) && (std::memcmp(pSegmented, kArray, sizeof(kArray)) == 0);
+
+	// Tag state of a VERIFY_ONCE site: a pass or a sticky failure in one TU says nothing about the other.
+	VerifiedSite<CryptoAES::Verification::OncePerSite, __LINE__> TamperedInFirst(_CRYPTOMULTITU_TEXT);
+	VerifiedSite<CryptoAES::Verification::OncePerSite, __LINE__> TamperedInSecond(_CRYPTOMULTITU_TEXT);
+	if (kFirst) {
+		Tamper(TamperedInFirst);
+	} else {
+		Tamper(TamperedInSecond);
+	}
+	bOK &= (std::strcmp(TamperedInFirst.Decrypt(), _CRYPTOMULTITU_TEXT) == 0) == !kFirst;
+	bOK &= (std::strcmp(TamperedInSecond.Decrypt(), _CRYPTOMULTITU_TEXT) == 0) == kFirst;
+
+	// A VERIFY_BATCHED site queues itself per TU, so VerifyPending() checks both copies and finds the second one.
+	static VerifiedSite<CryptoAES::Verification::Batched, __LINE__> Batched(_CRYPTOMULTITU_TEXT);
+	if (!kFirst) {
+		Tamper(Batched);
+	}
+	bOK &= std::strcmp(Batched.Decrypt(), _CRYPTOMULTITU_TEXT) == 0;
+
+	return bOK;
+}
+
+#ifndef CRYPTOMULTITU_SECOND
+bool CheckSecond();
+
+int main() {
+#ifdef CRYPTOREGISTRY
+	const CryptoRegistry::BulkResult result = CryptoRegistry::DecryptAll();
+	std::printf("registry: %zu decrypted, %zu failed\n", result.m_unDecrypted, result.m_unFailed);
+#endif
+
+	const bool bFirst = CheckFirst();
+	const bool bSecond = CheckSecond();
+	const bool bBatched = CryptoAES::VerifyPending() == 1;
+
+	std::printf("first: %s\nsecond: %s\nbatched: %s\n", bFirst ? "ok" : "FAILED", bSecond ? "ok" : "FAILED", bBatched ? "ok" : "FAILED");
+
+	return (bFirst && bSecond && bBatched) ? 0 : 1;
+}
+#endif
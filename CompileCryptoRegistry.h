@@ -0,0 +1,298 @@
+#pragma once
+
+#ifndef _COMPILECRYPTOREGISTRY_H_
+#define _COMPILECRYPTOREGISTRY_H_
+
+// STL
+#include <type_traits>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// ----------------------------------------------------------------
+// General definitions
+// ----------------------------------------------------------------
+
+#if defined(_MSC_VER)
+#define _CRYPTOREGISTRY_NO_INLINE __declspec(noinline)
+#define _CRYPTOREGISTRY_FORCE_INLINE __forceinline
+#elif defined(__GNUC__) || defined(__clang__)
+#define _CRYPTOREGISTRY_NO_INLINE __attribute__((noinline))
+#define _CRYPTOREGISTRY_FORCE_INLINE __attribute__((always_inline))
+#else
+#define _CRYPTOREGISTRY_NO_INLINE
+#define _CRYPTOREGISTRY_FORCE_INLINE inline
+#endif
+
+// Every registered site puts one Entry into this section; the linker concatenates them across translation units.
+#if defined(_MSC_VER)
+#pragma section("CRYPTOREG$A", read, write)
+#pragma section("CRYPTOREG$M", read, write)
+#pragma section("CRYPTOREG$Z", read, write)
+#define _CRYPTOREGISTRY_SECTION __declspec(allocate("CRYPTOREG$M"))
+#elif defined(__ELF__)
+#define _CRYPTOREGISTRY_SECTION __attribute__((section("cryptoregistry"), used))
+#else
+#error "CompileCryptoRegistry.h needs an ELF or PE/COFF target"
+#endif
+
+// ----------------------------------------------------------------
+// CryptoRegistry
+// ----------------------------------------------------------------
+
+// Enumerates the CRYPTOSTRING/CRYPTOARRAY/CRYPTOSTRINGAES/CRYPTOARRAYAES sites of the whole program (define CRYPTOREGISTRY
+// before including those headers) and decrypts them in one batch into a read-only arena at startup.
+namespace CryptoRegistry {
+
+	enum class Kind : unsigned char {
+		String,
+		Array,
+		StringAES,
+		ArrayAES
+	};
+
+	// One cache line each: the compiler may over-align larger statics, and the section is walked with a fixed stride.
+	struct alignas(64) Entry {
+		bool (*m_pDecrypt)(const void* pSite, void* pOut) noexcept;
+		const void* m_pSite;
+		std::size_t m_unSize;
+		std::size_t m_unAlignment;
+		Kind m_eKind;
+		const void* m_pResident; // Plaintext in the arena once DecryptAll has run; accessed through std::atomic_ref.
+
+		_CRYPTOREGISTRY_FORCE_INLINE const void* Resident() const noexcept {
+			return std::atomic_ref<const void*>(const_cast<const void*&>(m_pResident)).load(std::memory_order_acquire);
+		}
+	};
+
+	template<class Site>
+	bool DecryptSite(const void* pSite, void* pOut) noexcept {
+		return static_cast<const Site*>(pSite)->DecryptInto(static_cast<typename Site::value_type*>(pOut));
+	}
+
+	template<class Site>
+	constexpr Entry MakeEntry(const Site& site, Kind eKind) noexcept {
+		using T = typename Site::value_type;
+		return Entry { &DecryptSite<Site>, &site, Site::size() * sizeof(T), alignof(T), eKind, nullptr };
+	}
+
+	// Copies out of the arena when the site is resident, otherwise decrypts as usual; the result type is the site's own.
+	template<class Site>
+	_CRYPTOREGISTRY_FORCE_INLINE inline auto Decrypt(const Site& site, const Entry& entry) noexcept {
+		using Result = decltype(site.Decrypt());
+
+		if (const void* pResident = entry.Resident()) {
+			return Result(static_cast<const typename Site::value_type*>(pResident));
+		}
+
+		return site.Decrypt();
+	}
+
+#if defined(_MSC_VER)
+	__declspec(allocate("CRYPTOREG$A")) inline Entry g_SectionBegin {};
+	__declspec(allocate("CRYPTOREG$Z")) inline Entry g_SectionEnd {};
+
+	inline Entry* SectionBegin() noexcept { return &g_SectionBegin + 1; }
+	inline Entry* SectionEnd() noexcept { return &g_SectionEnd; }
+#else
+} // namespace CryptoRegistry
+
+extern "C" CryptoRegistry::Entry __start_cryptoregistry[] __attribute__((weak, visibility("hidden")));
+extern "C" CryptoRegistry::Entry __stop_cryptoregistry[] __attribute__((weak, visibility("hidden")));
+
+namespace CryptoRegistry {
+
+	inline Entry* SectionBegin() noexcept { return __start_cryptoregistry; }
+	inline Entry* SectionEnd() noexcept { return __stop_cryptoregistry; }
+#endif
+
+	// Calls fnVisit(Entry&) for every registered site. Linker padding between entries shows up as all-zero slots and is skipped.
+	template<class Fn>
+	void ForEach(Fn&& fnVisit) {
+		for (Entry* pEntry = SectionBegin(); pEntry && (pEntry < SectionEnd()); ++pEntry) {
+			if (pEntry->m_pDecrypt) {
+				fnVisit(*pEntry);
+			}
+		}
+	}
+
+	inline std::size_t Count() noexcept {
+		std::size_t unCount = 0;
+		ForEach([&unCount](const Entry&) noexcept { ++unCount; });
+		return unCount;
+	}
+
+	struct BulkResult {
+		std::size_t m_unDecrypted;
+		std::size_t m_unFailed;
+		std::size_t m_unArenaSize;
+	};
+
+	struct Arena {
+		void* m_pBase;
+		std::size_t m_unSize;
+	};
+
+	inline std::atomic<bool> g_bBulkStarted { false };
+	inline Arena g_Arena {};
+
+	inline void* ArenaAllocate(std::size_t unSize) noexcept {
+#if defined(_WIN32)
+		return VirtualAlloc(nullptr, unSize, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+#else
+		void* pBase = mmap(nullptr, unSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		return (pBase == MAP_FAILED) ? nullptr : pBase;
+#endif
+	}
+
+	inline bool ArenaSeal(void* pBase, std::size_t unSize) noexcept {
+#if defined(_WIN32)
+		DWORD unOldProtect = 0;
+		return VirtualProtect(pBase, unSize, PAGE_READONLY, &unOldProtect) != FALSE;
+#else
+		return mprotect(pBase, unSize, PROT_READ) == 0;
+#endif
+	}
+
+	// Wipes an arena that will not be published and gives it back; it may hold plaintext from finished workers.
+	inline void ArenaDiscard(void* pBase, std::size_t unSize) noexcept {
+		volatile unsigned char* pData = static_cast<volatile unsigned char*>(pBase);
+		for (std::size_t i = 0; i < unSize; ++i) {
+			pData[i] = 0;
+		}
+
+#if defined(_WIN32)
+		VirtualFree(pBase, 0, MEM_RELEASE);
+#else
+		munmap(pBase, unSize);
+#endif
+	}
+
+	inline std::size_t ArenaPageSize() noexcept {
+#if defined(_WIN32)
+		SYSTEM_INFO si {};
+		GetSystemInfo(&si);
+		return static_cast<std::size_t>(si.dwPageSize);
+#else
+		return static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#endif
+	}
+
+	// Decrypts every site accepted by fnSelect(const Entry&) into one arena, split across unThreads workers
+	// (0 = hardware concurrency), then makes the arena read-only and publishes it. Later uses of those sites copy
+	// from the arena instead of decrypting. Runs once per process; sites whose tag fails stay non-resident.
+	template<class Fn>
+	_CRYPTOREGISTRY_NO_INLINE BulkResult DecryptSelected(Fn&& fnSelect, unsigned int unThreads = 0) {
+		if (g_bBulkStarted.exchange(true, std::memory_order_acq_rel)) {
+			return BulkResult {};
+		}
+
+		std::vector<Entry*> vecEntries;
+		std::vector<std::size_t> vecOffsets;
+		std::size_t unSize = 0;
+
+		ForEach([&](Entry& entry) {
+			if (!fnSelect(static_cast<const Entry&>(entry))) {
+				return;
+			}
+
+			unSize = (unSize + entry.m_unAlignment - 1) & ~(entry.m_unAlignment - 1);
+			vecEntries.push_back(&entry);
+			vecOffsets.push_back(unSize);
+			unSize += entry.m_unSize;
+		});
+
+		if (vecEntries.empty()) {
+			return BulkResult {};
+		}
+
+		const std::size_t unPageSize = ArenaPageSize();
+		unSize = (unSize + unPageSize - 1) & ~(unPageSize - 1);
+
+		unsigned char* pBase = static_cast<unsigned char*>(ArenaAllocate(unSize));
+		if (!pBase) {
+			return BulkResult { 0, vecEntries.size(), 0 };
+		}
+
+		if (!unThreads) {
+			unThreads = std::thread::hardware_concurrency();
+		}
+
+		if (unThreads > vecEntries.size()) {
+			unThreads = static_cast<unsigned int>(vecEntries.size());
+		}
+
+		std::vector<unsigned char> vecValid(vecEntries.size(), 0);
+		std::atomic<std::size_t> unNext { 0 };
+
+		auto Worker = [&]() noexcept {
+			for (std::size_t i = unNext.fetch_add(1, std::memory_order_relaxed); i < vecEntries.size(); i = unNext.fetch_add(1, std::memory_order_relaxed)) {
+				const Entry& entry = *vecEntries[i];
+				vecValid[i] = entry.m_pDecrypt(entry.m_pSite, pBase + vecOffsets[i]) ? 1 : 0;
+			}
+		};
+
+		std::vector<std::thread> vecThreads;
+		try {
+			// Reserved up front: a reallocation inside emplace_back would destroy the new, still joinable thread.
+			vecThreads.reserve(unThreads ? (unThreads - 1) : 0);
+			for (unsigned int i = 1; i < unThreads; ++i) {
+				vecThreads.emplace_back(Worker);
+			}
+		} catch (...) {
+			// Claims the remaining sites so the started workers return, then drops the partial arena and allows a retry.
+			unNext.store(vecEntries.size(), std::memory_order_relaxed);
+			for (std::thread& thread : vecThreads) {
+				thread.join();
+			}
+
+			ArenaDiscard(pBase, unSize);
+			g_bBulkStarted.store(false, std::memory_order_release);
+			throw;
+		}
+
+		Worker();
+
+		for (std::thread& thread : vecThreads) {
+			thread.join();
+		}
+
+		if (!ArenaSeal(pBase, unSize)) {
+			ArenaDiscard(pBase, unSize);
+			return BulkResult { 0, vecEntries.size(), 0 };
+		}
+
+		g_Arena = Arena { pBase, unSize };
+
+		BulkResult result { 0, 0, unSize };
+		for (std::size_t i = 0; i < vecEntries.size(); ++i) {
+			if (vecValid[i]) {
+				std::atomic_ref<const void*>(vecEntries[i]->m_pResident).store(pBase + vecOffsets[i], std::memory_order_release);
+				++result.m_unDecrypted;
+			} else {
+				++result.m_unFailed;
+			}
+		}
+
+		return result;
+	}
+
+	inline BulkResult DecryptAll(unsigned int unThreads = 0) {
+		return DecryptSelected([](const Entry&) noexcept { return true; }, unThreads);
+	}
+}
+
+#define _CRYPTOREGISTRY_SITE(ENCRYPTED, KIND) \
+	_CRYPTOREGISTRY_SECTION constinit static CryptoRegistry::Entry RegistryEntry = CryptoRegistry::MakeEntry(ENCRYPTED, KIND)
+
+#undef _CRYPTOREGISTRY_FORCE_INLINE
+#undef _CRYPTOREGISTRY_NO_INLINE
+
+#endif // !_COMPILECRYPTOREGISTRY_H_
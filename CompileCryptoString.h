@@ -5,11 +5,26 @@
 
 // STL
 #include <type_traits>
+#include <cstring>
+#include <cerrno>
+#include <exception>
+#include <ostream>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 
 // CompileTimeStamp
 #define COMPILETIMESTAMP_USE_64BIT
 #include "CompileTimeStamp.h"
 
+#ifdef CRYPTOREGISTRY
+// CompileCryptoRegistry
+#include "CompileCryptoRegistry.h"
+#endif
+
 // ----------------------------------------------------------------
 // General definitions
 // ----------------------------------------------------------------
@@ -25,6 +40,24 @@
 #define _CRYPTOSTRING_FORCE_INLINE inline
 #endif
 
+// Runtime XOR width follows the compiler's target flags (-mavx2, /arch:AVX2); define CRYPTOSTRING_NO_SIMD for the 64-bit scalar path only.
+#if !defined(CRYPTOSTRING_NO_SIMD) && defined(__AVX2__)
+#define _CRYPTOSTRING_AVX2
+#endif
+
+#if !defined(CRYPTOSTRING_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)))
+#define _CRYPTOSTRING_SSE2
+#endif
+
+#if defined(_CRYPTOSTRING_AVX2) || defined(_CRYPTOSTRING_SSE2)
+#include <immintrin.h>
+#endif
+
+// Plaintext bytes are the little-endian image of each element, so on little-endian targets they are written straight into T storage.
+#if defined(_MSC_VER) || (defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__))
+#define _CRYPTOSTRING_LITTLE_ENDIAN
+#endif
+
 // ----------------------------------------------------------------
 // CryptoString
 // ----------------------------------------------------------------
@@ -154,6 +187,99 @@ namespace CryptoString {
 		unsigned char m_Data[64] {};
 	};
 
+	// Site keystream: byte j is kBaseKey[j % 32] ^ AdditionalKey[j % 64], so it repeats every 64 bytes.
+	template<unsigned long long unLine, unsigned long long unCounter>
+	class KeystreamTable {
+	public:
+		constexpr KeystreamTable() noexcept {
+			const AdditionalKeyArray<unLine, unCounter> AdditionalKey {};
+
+			for (unsigned char i = 0; i < 64; ++i) {
+				m_Data[i] = static_cast<unsigned char>(kBaseKey[i % sizeof(kBaseKey)] ^ AdditionalKey.m_Data[i]);
+			}
+		}
+
+	public:
+		alignas(64) unsigned char m_Data[64] {};
+	};
+
+	// Computed at compile time, one table per (unLine, unCounter). Internal linkage like kBaseKey: another translation unit
+	// built at a different time has a different table for the same line and counter.
+	template<unsigned long long unLine, unsigned long long unCounter>
+	constexpr static KeystreamTable<unLine, unCounter> kKeystream {};
+
+	// Decryption reads the table through a volatile pointer: with both the ciphertext and the table visible as constants the
+	// optimizer would otherwise fold the plaintext into immediates.
+	template<unsigned long long unLine, unsigned long long unCounter>
+	static const unsigned char* const volatile g_pKeystream = kKeystream<unLine, unCounter>.m_Data;
+
+	// pOut[j] = pIn[j] ^ pKeystream[j % 64] for a 64-byte aligned keystream: a whole period per iteration, then 8 bytes at a time.
+	// Internal linkage: the body follows this TU's target flags, and TUs built with and without -mavx2 must not share one copy.
+	static inline void XORKeystream(const unsigned char* pIn, unsigned char* pOut, std::size_t unSize, const unsigned char* pKeystream) noexcept {
+		std::size_t unOffset = 0;
+
+#if defined(_CRYPTOSTRING_AVX2)
+		const __m256i K0 = _mm256_load_si256(reinterpret_cast<const __m256i*>(pKeystream));
+		const __m256i K1 = _mm256_load_si256(reinterpret_cast<const __m256i*>(pKeystream + 32));
+
+		for (; unOffset + 64 <= unSize; unOffset += 64) {
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(pOut + unOffset), _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(pIn + unOffset)), K0));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(pOut + unOffset + 32), _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(pIn + unOffset + 32)), K1));
+		}
+#elif defined(_CRYPTOSTRING_SSE2)
+		const __m128i K0 = _mm_load_si128(reinterpret_cast<const __m128i*>(pKeystream));
+		const __m128i K1 = _mm_load_si128(reinterpret_cast<const __m128i*>(pKeystream + 16));
+		const __m128i K2 = _mm_load_si128(reinterpret_cast<const __m128i*>(pKeystream + 32));
+		const __m128i K3 = _mm_load_si128(reinterpret_cast<const __m128i*>(pKeystream + 48));
+
+		for (; unOffset + 64 <= unSize; unOffset += 64) {
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pOut + unOffset), _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pIn + unOffset)), K0));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pOut + unOffset + 16), _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pIn + unOffset + 16)), K1));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pOut + unOffset + 32), _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pIn + unOffset + 32)), K2));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pOut + unOffset + 48), _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pIn + unOffset + 48)), K3));
+		}
+#endif
+
+		const std::size_t unWordEnd = unSize & ~static_cast<std::size_t>(7);
+		for (; unOffset < unWordEnd; unOffset += 8) {
+			unsigned long long unX = 0;
+			unsigned long long unKey = 0;
+			std::memcpy(&unX, pIn + unOffset, sizeof(unX));
+			std::memcpy(&unKey, pKeystream + (unOffset % 64), sizeof(unKey));
+
+			unX ^= unKey;
+			std::memcpy(pOut + unOffset, &unX, sizeof(unX));
+		}
+
+		for (; unOffset < unSize; ++unOffset) {
+			pOut[unOffset] = static_cast<unsigned char>(pIn[unOffset] ^ pKeystream[unOffset % 64]);
+		}
+	}
+
+	// Writes all of pData to a file descriptor, retrying interrupted and partial writes.
+	inline bool WriteAll(int nFD, const void* pData, std::size_t unSize) noexcept {
+		const unsigned char* pBytes = static_cast<const unsigned char*>(pData);
+		while (unSize) {
+#if defined(_WIN32)
+			const int nWritten = _write(nFD, pBytes, static_cast<unsigned int>(unSize));
+#else
+			const ssize_t nWritten = ::write(nFD, pBytes, unSize);
+#endif
+			if (nWritten < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+
+				return false;
+			}
+
+			pBytes += nWritten;
+			unSize -= static_cast<std::size_t>(nWritten);
+		}
+
+		return true;
+	}
+
 	template<typename T, std::size_t N>
 	struct ByteIO;
 
@@ -202,27 +328,31 @@ namespace CryptoString {
 		}
 	};
 
+	// Site classes read the TU-local keystream, so they are TU-local too; the registry stores a pointer to their DecryptInto.
+	namespace {
+
 	template <unsigned long long unLength, typename T, unsigned long long unLine = 0, unsigned long long unCounter = 0>
 	class CryptoString {
 	private:
 		static constexpr std::size_t kLength = static_cast<std::size_t>(unLength);
 		static constexpr std::size_t kPlainBytes = kLength * sizeof(T);
+		static constexpr std::size_t kTextLength = (kLength > 0) ? (kLength - 1) : 0;
 
 	public:
+		using value_type = T;
+
+		static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
 		class DecryptedString {
 		public:
 			_CRYPTOSTRING_FORCE_INLINE explicit DecryptedString(const CryptoString& EncryptedString) noexcept {
-				AdditionalKeyArray<unLine, unCounter> AdditionalKey {};
+				EncryptedString.DecryptInto(m_Buffer);
+			}
 
+			// Copies plaintext that is already available (see CryptoRegistry::Decrypt).
+			_CRYPTOSTRING_FORCE_INLINE explicit DecryptedString(const T* pPlainText) noexcept {
 				for (std::size_t i = 0; i < kLength; ++i) {
-					unsigned char tmp[sizeof(T)] {};
-
-					for (std::size_t k = 0; k < sizeof(T); ++k) {
-						const std::size_t j = i * sizeof(T) + k;
-						tmp[k] = EncryptedString.m_Storage[j] ^ kBaseKey[j % sizeof(kBaseKey)] ^ AdditionalKey.m_Data[j % sizeof(AdditionalKey.m_Data)];
-					}
-
-					m_Buffer[i] = ByteIO<T, sizeof(T)>::from(tmp);
+					m_Buffer[i] = pPlainText[i];
 				}
 			}
 
@@ -293,21 +423,306 @@ namespace CryptoString {
 			return DecryptedString(*this);
 		}
 
+		// Writes the kLength decrypted elements to pOut.
+		_CRYPTOSTRING_FORCE_INLINE bool DecryptInto(T* pOut) const noexcept {
+			unsigned char* pBytes = reinterpret_cast<unsigned char*>(pOut);
+			XORKeystream(m_Storage, pBytes, kPlainBytes, g_pKeystream<unLine, unCounter>);
+
+#ifndef _CRYPTOSTRING_LITTLE_ENDIAN
+			// Rebuild element i in place from the little-endian bytes occupying its own storage.
+			if constexpr (sizeof(T) > 1) {
+				for (std::size_t i = 0; i < kLength; ++i) {
+					unsigned char bytes[sizeof(T)] {};
+					for (std::size_t j = 0; j < sizeof(T); ++j) {
+						bytes[j] = pBytes[i * sizeof(T) + j];
+					}
+
+					pOut[i] = ByteIO<T, sizeof(T)>::from(bytes);
+				}
+			}
+#endif
+
+			return true;
+		}
+
+		// Writes the kLength decrypted elements straight into the caller's buffer, which holds unCapacity elements; returns the number
+		// written, or 0 (buffer untouched) when it is too small.
+		_CRYPTOSTRING_FORCE_INLINE std::size_t DecryptTo(T* pDst, std::size_t unCapacity) const noexcept {
+			if (!pDst || (unCapacity < kLength)) {
+				return 0;
+			}
+
+			return DecryptInto(pDst) ? kLength : 0;
+		}
+
+		// Comparisons against the literal (without its terminator). Each element, or 8 bytes at a time on little-endian targets,
+		// is decrypted into a register and compared there: the plaintext is never written to memory and the scan stops at the
+		// first difference. Overloads without a length take a null-terminated text and compare the literal's terminator too,
+		// so they stop at the text's end.
+		_CRYPTOSTRING_FORCE_INLINE bool Equals(const T* pText) const noexcept {
+			const unsigned char* pKeystream = g_pKeystream<unLine, unCounter>;
+			for (std::size_t i = 0; i < kLength; ++i) {
+				if (DecryptUnit(i, pKeystream) != static_cast<Unit>(pText[i])) {
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		_CRYPTOSTRING_FORCE_INLINE bool Equals(const T* pText, std::size_t unTextLength) const noexcept {
+			return (unTextLength == kTextLength) && (Mismatch(pText, kTextLength, g_pKeystream<unLine, unCounter>) == kTextLength);
+		}
+
+		// Same result as Equals, but every element is visited whatever the text, so the timing only depends on unTextLength.
+		_CRYPTOSTRING_FORCE_INLINE bool EqualsConstantTime(const T* pText, std::size_t unTextLength) const noexcept {
+			if (unTextLength != kTextLength) {
+				return false;
+			}
+
+			const unsigned char* pKeystream = g_pKeystream<unLine, unCounter>;
+
+			unsigned long long unDiff = 0;
+			std::size_t i = 0;
+
+#ifdef _CRYPTOSTRING_LITTLE_ENDIAN
+			constexpr std::size_t kWordEnd = kTextLength - (kTextLength % kWordElements);
+			for (; i < kWordEnd; i += kWordElements) {
+				unDiff |= DiffWord(pText, i, pKeystream);
+			}
+#endif
+
+			for (; i < kTextLength; ++i) {
+				unDiff |= static_cast<unsigned long long>(DecryptUnit(i, pKeystream) ^ static_cast<Unit>(pText[i]));
+			}
+
+			return unDiff == 0;
+		}
+
+		// strcmp ordering (elements compared as unsigned): negative, zero or positive.
+		_CRYPTOSTRING_FORCE_INLINE int Compare(const T* pText) const noexcept {
+			const unsigned char* pKeystream = g_pKeystream<unLine, unCounter>;
+			for (std::size_t i = 0; i < kLength; ++i) {
+				const Unit unLiteral = DecryptUnit(i, pKeystream);
+				const Unit unText = static_cast<Unit>(pText[i]);
+				if (unLiteral != unText) {
+					return (unLiteral < unText) ? -1 : 1;
+				}
+			}
+
+			return 0;
+		}
+
+		_CRYPTOSTRING_FORCE_INLINE int Compare(const T* pText, std::size_t unTextLength) const noexcept {
+			const unsigned char* pKeystream = g_pKeystream<unLine, unCounter>;
+
+			const std::size_t unCommon = (unTextLength < kTextLength) ? unTextLength : kTextLength;
+			const std::size_t unIndex = Mismatch(pText, unCommon, pKeystream);
+			if (unIndex < unCommon) {
+				return (DecryptUnit(unIndex, pKeystream) < static_cast<Unit>(pText[unIndex])) ? -1 : 1;
+			}
+
+			return (kTextLength < unTextLength) ? -1 : ((kTextLength > unTextLength) ? 1 : 0);
+		}
+
+		// The literal starts with pPrefix.
+		_CRYPTOSTRING_FORCE_INLINE bool StartsWith(const T* pPrefix, std::size_t unPrefixLength) const noexcept {
+			return (unPrefixLength <= kTextLength) && (Mismatch(pPrefix, unPrefixLength, g_pKeystream<unLine, unCounter>) == unPrefixLength);
+		}
+
+		// pText starts with the literal.
+		_CRYPTOSTRING_FORCE_INLINE bool IsPrefixOf(const T* pText, std::size_t unTextLength) const noexcept {
+			return (unTextLength >= kTextLength) && (Mismatch(pText, kTextLength, g_pKeystream<unLine, unCounter>) == kTextLength);
+		}
+
+		// Position of the first occurrence of the literal in pText, or npos.
+		_CRYPTOSTRING_FORCE_INLINE std::size_t Find(const T* pText, std::size_t unTextLength) const noexcept {
+			if (unTextLength < kTextLength) {
+				return npos;
+			}
+
+			if constexpr (kTextLength == 0) {
+				return 0;
+			} else {
+				const unsigned char* pKeystream = g_pKeystream<unLine, unCounter>;
+
+				const Unit unFirst = DecryptUnit(0, pKeystream);
+				for (std::size_t i = 0; i + kTextLength <= unTextLength; ++i) {
+					if ((static_cast<Unit>(pText[i]) == unFirst) && (Mismatch(pText + i, kTextLength, pKeystream) == kTextLength)) {
+						return i;
+					}
+				}
+
+				return npos;
+			}
+		}
+
+		// Streams the text (without its terminator) one 64-byte window at a time, so output starts before the rest is decrypted
+		// and no more than a window of plaintext exists outside the stream's own buffer.
+		template<class Traits>
+		friend std::basic_ostream<T, Traits>& operator<<(std::basic_ostream<T, Traits>& Stream, const CryptoString& EncryptedString) {
+			std::exception_ptr pException;
+			EncryptedString.VisitWindows([&](const T* pWindow, std::size_t unElements) noexcept {
+				try {
+					Stream.write(pWindow, static_cast<std::streamsize>(unElements));
+				} catch (...) {
+					pException = std::current_exception();
+					return false;
+				}
+
+				return Stream.good();
+			});
+
+			// Rethrown only once the window has been wiped.
+			if (pException) {
+				std::rethrow_exception(pException);
+			}
+
+			return Stream;
+		}
+
+		// Writes the raw elements of the text (without its terminator) to a file descriptor window by window; false on a write error.
+		_CRYPTOSTRING_FORCE_INLINE bool WriteTo(int nFD) const noexcept {
+			bool bWritten = true;
+			VisitWindows([&](const T* pWindow, std::size_t unElements) noexcept {
+				bWritten = WriteAll(nFD, pWindow, unElements * sizeof(T));
+				return bWritten;
+			});
+
+			return bWritten;
+		}
+
+		static constexpr std::size_t size() noexcept { return kLength; }
+
 	private:
+		using Unit = std::conditional_t<sizeof(T) == 1, unsigned char, std::conditional_t<sizeof(T) == 2, unsigned short, unsigned int>>;
+
+		static constexpr std::size_t kWordElements = 8 / sizeof(T);
+		static constexpr std::size_t kWindowElements = 64 / sizeof(T);
+
+		// Decrypts the text one keystream period at a time into a stack window and calls fnVisit(pWindow, unElements) until it
+		// returns false; the window is wiped before returning.
+		template<class Fn>
+		_CRYPTOSTRING_FORCE_INLINE void VisitWindows(Fn&& fnVisit) const noexcept {
+			const unsigned char* pKeystream = g_pKeystream<unLine, unCounter>;
+
+			T window[kWindowElements] {};
+			unsigned char* pBytes = reinterpret_cast<unsigned char*>(window);
+
+			for (std::size_t unIndex = 0; unIndex < kTextLength; unIndex += kWindowElements) {
+				const std::size_t unElements = ((kTextLength - unIndex) < kWindowElements) ? (kTextLength - unIndex) : kWindowElements;
+
+				XORKeystream(m_Storage + unIndex * sizeof(T), pBytes, unElements * sizeof(T), pKeystream);
+
+#ifndef _CRYPTOSTRING_LITTLE_ENDIAN
+				if constexpr (sizeof(T) > 1) {
+					for (std::size_t i = 0; i < unElements; ++i) {
+						unsigned char bytes[sizeof(T)] {};
+						for (std::size_t j = 0; j < sizeof(T); ++j) {
+							bytes[j] = pBytes[i * sizeof(T) + j];
+						}
+
+						window[i] = ByteIO<T, sizeof(T)>::from(bytes);
+					}
+				}
+#endif
+
+				if (!fnVisit(static_cast<const T*>(window), unElements)) {
+					break;
+				}
+			}
+
+			volatile T* pWindow = window;
+			for (std::size_t i = 0; i < kWindowElements; ++i) {
+				pWindow[i] = T {};
+			}
+		}
+
+		// Element i, decrypted into a register.
+		_CRYPTOSTRING_FORCE_INLINE Unit DecryptUnit(std::size_t i, const unsigned char* pKeystream) const noexcept {
+			Unit unX = 0;
+			for (std::size_t k = 0; k < sizeof(T); ++k) {
+				const std::size_t j = i * sizeof(T) + k;
+				unX |= static_cast<Unit>(static_cast<Unit>(m_Storage[j] ^ pKeystream[j % 64]) << (8 * k));
+			}
+
+			return unX;
+		}
+
+		// Ciphertext ^ keystream ^ text for the 8 bytes holding elements [i, i + kWordElements): zero exactly where they match.
+		_CRYPTOSTRING_FORCE_INLINE unsigned long long DiffWord(const T* pText, std::size_t i, const unsigned char* pKeystream) const noexcept {
+			const std::size_t j = i * sizeof(T);
+
+			unsigned long long unCipher = 0;
+			unsigned long long unKey = 0;
+			unsigned long long unText = 0;
+			std::memcpy(&unCipher, m_Storage + j, sizeof(unCipher));
+			std::memcpy(&unKey, pKeystream + (j % 64), sizeof(unKey));
+			std::memcpy(&unText, pText + i, sizeof(unText));
+
+			return unCipher ^ unKey ^ unText;
+		}
+
+		// Index of the first of the unCount leading elements that differs from pText, or unCount.
+		_CRYPTOSTRING_FORCE_INLINE std::size_t Mismatch(const T* pText, std::size_t unCount, const unsigned char* pKeystream) const noexcept {
+			std::size_t i = 0;
+
+#ifdef _CRYPTOSTRING_LITTLE_ENDIAN
+			for (; (i + kWordElements <= unCount) && !DiffWord(pText, i, pKeystream); i += kWordElements) {}
+#endif
+
+			for (; (i < unCount) && (DecryptUnit(i, pKeystream) == static_cast<Unit>(pText[i])); ++i) {}
+
+			return i;
+		}
+
 		unsigned char m_Storage[kPlainBytes] {};
 	};
+
+	} // namespace
 }
 
+#ifdef CRYPTOREGISTRY
+#define _CRYPTOSTRING(STRING)                                                                                                                                     \
+	([]() -> auto {                                                                                                                                               \
+		constexpr size_t unLength = std::extent_v<std::remove_reference_t<decltype(STRING)>>;                                                                     \
+		static constexpr auto Encrypted = CryptoString::CryptoString<unLength, CryptoString::clean_type<decltype((STRING)[0])>, __LINE__, __COUNTER__>((STRING)); \
+		_CRYPTOREGISTRY_SITE(Encrypted, CryptoRegistry::Kind::String);                                                                                            \
+		return CryptoRegistry::Decrypt(Encrypted, RegistryEntry);                                                                                                 \
+	} ())
+#else
 #define _CRYPTOSTRING(STRING)                                                                                                                              \
 	([]() -> auto {                                                                                                                                        \
 		constexpr size_t unLength = std::extent_v<std::remove_reference_t<decltype(STRING)>>;                                                              \
 		constexpr auto Encrypted = CryptoString::CryptoString<unLength, CryptoString::clean_type<decltype((STRING)[0])>, __LINE__, __COUNTER__>((STRING)); \
 		return Encrypted.Decrypt();                                                                                                                        \
 	} ())
+#endif
 
 #define CRYPTOSTRING(STRING) _CRYPTOSTRING(STRING)
 
+#define _CRYPTOSTRING_TO(STRING, DST, CAP)                                                                                                                 \
+	([&]() -> std::size_t {                                                                                                                                \
+		constexpr size_t unLength = std::extent_v<std::remove_reference_t<decltype(STRING)>>;                                                              \
+		constexpr auto Encrypted = CryptoString::CryptoString<unLength, CryptoString::clean_type<decltype((STRING)[0])>, __LINE__, __COUNTER__>((STRING)); \
+		return Encrypted.DecryptTo((DST), (CAP));                                                                                                          \
+	} ())
+
+#define CRYPTOSTRING_TO(STRING, DST, CAP) _CRYPTOSTRING_TO(STRING, DST, CAP)
+
+#define _CRYPTOSTRING_ENCRYPTED(STRING)                                                                                                                           \
+	([]() -> const auto& {                                                                                                                                        \
+		constexpr size_t unLength = std::extent_v<std::remove_reference_t<decltype(STRING)>>;                                                                     \
+		static constexpr auto Encrypted = CryptoString::CryptoString<unLength, CryptoString::clean_type<decltype((STRING)[0])>, __LINE__, __COUNTER__>((STRING)); \
+		return Encrypted;                                                                                                                                         \
+	} ())
+
+#define CRYPTOSTRING_ENCRYPTED(STRING) _CRYPTOSTRING_ENCRYPTED(STRING)
+
 #undef _CRYPTOSTRING_FORCE_INLINE
 #undef _CRYPTOSTRING_NO_INLINE
+#undef _CRYPTOSTRING_AVX2
+#undef _CRYPTOSTRING_SSE2
+#undef _CRYPTOSTRING_LITTLE_ENDIAN
 
 #endif // !_COMPILECRYPTOSTRING_H_
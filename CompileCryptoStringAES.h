@@ -4,11 +4,29 @@
 #define _COMPILECRYPTOSTRINGAES_H_
 
 #include <type_traits>
+#include <atomic>
+#include <cerrno>
+#include <exception>
+#include <ostream>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 
 // CompileTimeStamp
 #define COMPILETIMESTAMP_USE_64BIT
 #include "CompileTimeStamp.h"
 
+// CompileCryptoAES
+#include "CompileCryptoAES.h"
+
+#ifdef CRYPTOREGISTRY
+// CompileCryptoRegistry
+#include "CompileCryptoRegistry.h"
+#endif
+
 // ----------------------------------------------------------------
 // General definitions
 // ----------------------------------------------------------------
@@ -24,401 +42,24 @@
 #define _CRYPTOSTRINGAES_FORCE_INLINE inline
 #endif
 
+// Pooled sites (CRYPTOSTRINGAES_POOLED) keep their blob in one shared read-only section, byte-packed: the explicit
+// alignment stops GCC from rounding every blob of 32 bytes or more up to a 32-byte boundary.
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__ELF__)
+#define _CRYPTOSTRINGAES_POOL __attribute__((section(".rodata.cryptostringaes_pool"), aligned(1)))
+#else
+#define _CRYPTOSTRINGAES_POOL
+#endif
+
 // ----------------------------------------------------------------
 // CryptoStringAES
 // ----------------------------------------------------------------
 
 namespace CryptoStringAES {
-	
-	template<class T>
-	using clean_type = std::remove_const_t<std::remove_reference_t<T>>;
-
-	template<std::size_t N>
-	struct Bytes {
-		_CRYPTOSTRINGAES_FORCE_INLINE constexpr unsigned char* data() noexcept { return m_Data; }
-		_CRYPTOSTRINGAES_FORCE_INLINE constexpr const unsigned char* data() const noexcept { return m_Data; }
-		_CRYPTOSTRINGAES_FORCE_INLINE constexpr std::size_t size() const noexcept { return N; }
-
-		_CRYPTOSTRINGAES_FORCE_INLINE constexpr unsigned char& operator[](std::size_t i) noexcept { return m_Data[i]; }
-		_CRYPTOSTRINGAES_FORCE_INLINE constexpr const unsigned char& operator[](std::size_t i) const noexcept { return m_Data[i]; }
-
-		unsigned char m_Data[N] {};
-	};
-
-	using block16 = Bytes<16>;
-	using block32 = Bytes<32>;
-	using iv12 = Bytes<12>;
-
-	constexpr static unsigned char kAAD[10] = { 'R', 'e', 'n', 'a', 'r', 'd', 'D', 'e', 'v', '\0' }; // RenardDev
-	constexpr static std::size_t kAADSize = sizeof(kAAD);
-
-	constexpr static unsigned char kIBS[256] = {
-		0x63, 0x7C, 0x77, 0x7B, 0xF2, 0x6B, 0x6F, 0xC5, 0x30, 0x01, 0x67, 0x2B, 0xFE, 0xD7, 0xAB,
-		0x76, 0xCA, 0x82, 0xC9, 0x7D, 0xFA, 0x59, 0x47, 0xF0, 0xAD, 0xD4, 0xA2, 0xAF, 0x9C, 0xA4,
-		0x72, 0xC0, 0xB7, 0xFD, 0x93, 0x26, 0x36, 0x3F, 0xF7, 0xCC, 0x34, 0xA5, 0xE5, 0xF1, 0x71,
-		0xD8, 0x31, 0x15, 0x04, 0xC7, 0x23, 0xC3, 0x18, 0x96, 0x05, 0x9A, 0x07, 0x12, 0x80, 0xE2,
-		0xEB, 0x27, 0xB2, 0x75, 0x09, 0x83, 0x2C, 0x1A, 0x1B, 0x6E, 0x5A, 0xA0, 0x52, 0x3B, 0xD6,
-		0xB3, 0x29, 0xE3, 0x2F, 0x84, 0x53, 0xD1, 0x00, 0xED, 0x20, 0xFC, 0xB1, 0x5B, 0x6A, 0xCB,
-		0xBE, 0x39, 0x4A, 0x4C, 0x58, 0xCF, 0xD0, 0xEF, 0xAA, 0xFB, 0x43, 0x4D, 0x33, 0x85, 0x45,
-		0xF9, 0x02, 0x7F, 0x50, 0x3C, 0x9F, 0xA8, 0x51, 0xA3, 0x40, 0x8F, 0x92, 0x9D, 0x38, 0xF5,
-		0xBC, 0xB6, 0xDA, 0x21, 0x10, 0xFF, 0xF3, 0xD2, 0xCD, 0x0C, 0x13, 0xEC, 0x5F, 0x97, 0x44,
-		0x17, 0xC4, 0xA7, 0x7E, 0x3D, 0x64, 0x5D, 0x19, 0x73, 0x60, 0x81, 0x4F, 0xDC, 0x22, 0x2A,
-		0x90, 0x88, 0x46, 0xEE, 0xB8, 0x14, 0xDE, 0x5E, 0x0B, 0xDB, 0xE0, 0x32, 0x3A, 0x0A, 0x49,
-		0x06, 0x24, 0xC2, 0xD3, 0xAC, 0x62, 0x91, 0x95, 0xE4, 0x79, 0xE7, 0xC8, 0x37, 0x6D, 0x8D,
-		0xD5, 0x4E, 0xA9, 0x6C, 0x56, 0xF4, 0xEA, 0x65, 0x7A, 0xAE, 0x08, 0xBA, 0x78, 0x25, 0x2E,
-		0x1C, 0xA6, 0xB4, 0xC6, 0xE8, 0xDD, 0x74, 0x1F, 0x4B, 0xBD, 0x8B, 0x8A, 0x70, 0x3E, 0xB5,
-		0x66, 0x48, 0x03, 0xF6, 0x0E, 0x61, 0x35, 0x57, 0xB9, 0x86, 0xC1, 0x1D, 0x9E, 0xE1, 0xF8,
-		0x98, 0x11, 0x69, 0xD9, 0x8E, 0x94, 0x9B, 0x1E, 0x87, 0xE9, 0xCE, 0x55, 0x28, 0xDF, 0x8C,
-		0xA1, 0x89, 0x0D, 0xBF, 0xE6, 0x42, 0x68, 0x41, 0x99, 0x2D, 0x0F, 0xB0, 0x54, 0xBB, 0x16
-	};
-
-	constexpr static unsigned int kRCON[15] = {
-		0x00000000, 0x01000000, 0x02000000,
-		0x04000000, 0x08000000, 0x10000000,
-		0x20000000, 0x40000000, 0x80000000,
-		0x1B000000, 0x36000000, 0x6C000000,
-		0xD8000000, 0xAB000000, 0x4D000000
-	};
-
-	class AESState {
-	public:
-		constexpr AESState() noexcept = default;
-		constexpr explicit AESState(const block16& in) noexcept : m_State(in) {}
-
-	public:
-		constexpr void SubBytes() noexcept {
-			for (unsigned char i = 0; i < 16; ++i) {
-				m_State[i] = kIBS[m_State[i]];
-			}
-		}
-
-		constexpr void ShiftRows() noexcept {
-			unsigned char unT = m_State[1]; m_State[1] = m_State[5]; m_State[5] = m_State[9]; m_State[9] = m_State[13]; m_State[13] = unT;
-			unT = m_State[2]; m_State[2] = m_State[10]; m_State[10] = unT; unT = m_State[6]; m_State[6] = m_State[14]; m_State[14] = unT;
-			unT = m_State[3]; m_State[3] = m_State[15]; m_State[15] = m_State[11]; m_State[11] = m_State[7]; m_State[7] = unT;
-		}
-
-		constexpr void MixColumns() noexcept {
-			for (unsigned char c = 0; c < 4; ++c) {
-				const unsigned char i = static_cast<unsigned char>(4 * c);
-
-				const unsigned char a0 = m_State[i];
-				const unsigned char a1 = m_State[i + 1];
-				const unsigned char a2 = m_State[i + 2];
-				const unsigned char a3 = m_State[i + 3];
-
-				m_State[i]     = static_cast<unsigned char>(GFMul(0x02, a0) ^ GFMul(0x03, a1) ^ a2 ^ a3);
-				m_State[i + 1] = static_cast<unsigned char>(a0 ^ GFMul(0x02, a1) ^ GFMul(0x03, a2) ^ a3);
-				m_State[i + 2] = static_cast<unsigned char>(a0 ^ a1 ^ GFMul(0x02, a2) ^ GFMul(0x03, a3));
-				m_State[i + 3] = static_cast<unsigned char>(GFMul(0x03, a0) ^ a1 ^ a2 ^ GFMul(0x02, a3));
-			}
-		}
-
-		constexpr void AddRoundKeyWords(const unsigned int RK[4]) noexcept {
-			for (unsigned char c = 0; c < 4; ++c) {
-				const unsigned int unWord = RK[c];
-
-				m_State[4 * c]     ^= static_cast<unsigned char>((unWord >> 24) & 0xFF);
-				m_State[4 * c + 1] ^= static_cast<unsigned char>((unWord >> 16) & 0xFF);
-				m_State[4 * c + 2] ^= static_cast<unsigned char>((unWord >>  8) & 0xFF);
-				m_State[4 * c + 3] ^= static_cast<unsigned char>( unWord        & 0xFF);
-			}
-		}
-
-	private:
-		constexpr unsigned char GFMul(unsigned char unA, unsigned char unB) noexcept {
-			unsigned char unR = 0;
-			for (unsigned char i = 0; i < 8; ++i) {
-				if (unB & 1) {
-					unR ^= unA;
-				}
-
-				const bool bHi = (unA & 0x80) != 0;
-
-				unA <<= 1;
-
-				if (bHi) {
-					unA ^= 0x1B;
-				}
-
-				unB >>= 1;
-			}
-
-			return unR;
-		}
-
-	public:
-		block16 m_State {};
-	};
-
-	class AES256KeySchedule {
-	public:
-		constexpr AES256KeySchedule() noexcept = default;
-
-		constexpr explicit AES256KeySchedule(const block32& key) noexcept {
-			for (unsigned char i = 0; i < 8; ++i) {
-				m_Words[i] = _be32(&key[4 * i]);
-			}
-
-			for (unsigned char i = 8; i < 60; ++i) {
-				unsigned int unT = m_Words[i - 1];
-
-				if (i % 8 == 0) {
-					const unsigned int unRot = (unT << 8) | (unT >> 24);
-
-					const unsigned int unSub = (static_cast<unsigned int>(kIBS[(unRot >> 24) & 0xFF]) << 24) |
-											   (static_cast<unsigned int>(kIBS[(unRot >> 16) & 0xFF]) << 16) |
-											   (static_cast<unsigned int>(kIBS[(unRot >>  8) & 0xFF]) <<  8) |
-											   (static_cast<unsigned int>(kIBS[ unRot        & 0xFF]));
-
-					unT = unSub ^ kRCON[i / 8];
-
-				} else if (i % 8 == 4) {
-					const unsigned int unSub = (static_cast<unsigned int>(kIBS[(unT >> 24) & 0xFF]) << 24) |
-											   (static_cast<unsigned int>(kIBS[(unT >> 16) & 0xFF]) << 16) |
-											   (static_cast<unsigned int>(kIBS[(unT >>  8) & 0xFF]) <<  8) |
-											   (static_cast<unsigned int>(kIBS[ unT        & 0xFF]));
-
-					unT = unSub;
-				}
-
-				m_Words[i] = m_Words[i - 8] ^ unT;
-			}
-		}
-
-	private:
-		constexpr unsigned int _be32(const unsigned char* pBuffer) noexcept {
-			return (static_cast<unsigned int>(pBuffer[0]) << 24) |
-				   (static_cast<unsigned int>(pBuffer[1]) << 16) |
-				   (static_cast<unsigned int>(pBuffer[2]) <<  8) |
-					static_cast<unsigned int>(pBuffer[3]);
-		}
-
-	public:
-		unsigned int m_Words[60] {};
-	};
-
-	constexpr block16 AES256EncryptBlock(const block16& in, const AES256KeySchedule& ks) noexcept {
-		AESState state(in);
-		state.AddRoundKeyWords(&ks.m_Words[0]);
-
-		for (unsigned char unR = 1; unR <= 13; ++unR) {
-			state.SubBytes();
-			state.ShiftRows();
-			state.MixColumns();
-			state.AddRoundKeyWords(&ks.m_Words[4 * unR]);
-		}
-
-		state.SubBytes();
-		state.ShiftRows();
-		state.AddRoundKeyWords(&ks.m_Words[56]);
-
-		return state.m_State;
-	}
-
-	constexpr block16 GF128MulBE(const block16& X, const block16& Y) noexcept {
-		block16 Z {};
-		block16 V = Y;
-
-		for (unsigned char unBit = 0; unBit < 128; ++unBit) {
-			const unsigned char unBI = static_cast<unsigned char>(unBit / 8);
-			const char nB7 = static_cast<char>(7 - (unBit % 8));
-
-			if (((X[unBI] >> nB7) & 1) != 0) {
-				for (unsigned char i = 0; i < 16; ++i) {
-					Z[i] ^= V[i];
-				}
-			}
-
-			const bool bLSB = (V[15] & 1) != 0;
-
-			for (char j = 15; j > 0; --j) {
-				V[static_cast<unsigned char>(j)] = static_cast<unsigned char>((V[static_cast<unsigned char>(j)] >> 1) | ((V[static_cast<unsigned char>(j - 1)] & 1) << 7));
-			}
-
-			V[0] >>= 1;
-
-			if (bLSB) {
-				V[0] ^= 0xE1;
-			}
-		}
-
-		return Z;
-	}
-
-	constexpr void GHashAccamulate(const block16& H, const unsigned char* pData, std::size_t unDataLength, block16& accumulator) noexcept {
-		const std::size_t unBlocks = (unDataLength + 15) / 16;
-		block16 buffer {};
-
-		for (std::size_t b = 0; b < unBlocks; ++b) {
-			for (unsigned char i = 0; i < 16; ++i) {
-				const std::size_t unIndex = b * 16 + i;
-				buffer[i] = (unIndex < unDataLength) ? pData[unIndex] : 0;
-			}
-
-			for (unsigned char i = 0; i < 16; ++i) {
-				accumulator[i] ^= buffer[i];
-			}
-
-			accumulator = GF128MulBE(accumulator, H);
-		}
-	}
-
-	template <std::size_t unDataSize>
-	struct GCMResult {
-		std::size_t m_CipherTextSize = unDataSize;
-		unsigned char m_CipherText[unDataSize] {};
-		block16 m_Tag {};
-		constexpr GCMResult() noexcept = default;
-	};
-
-	constexpr void inc32_inplace(block16& ctr) noexcept {
-		for (char i = 15; i >= 12; --i) {
-			if (++ctr[static_cast<unsigned char>(i)] != 0) {
-				break;
-			}
-		}
-	}
 
-	template <std::size_t unDataSize, std::size_t unAADSize = 0>
-	constexpr GCMResult<unDataSize> GCMEncrypt(const unsigned char* pPlainText, const unsigned char* pAAD, const block32& key, const iv12& iv) noexcept {
-		GCMResult<unDataSize> out {};
+	using namespace CryptoAES;
 
-		const block16 zero {};
-		const AES256KeySchedule ks(key);
-		const block16 H = AES256EncryptBlock(zero, ks);
-
-		block16 J0 {};
-		for (unsigned char i = 0; i < 12; ++i) {
-			J0[i] = iv[i];
-		}
-
-		J0[15] = 1;
-
-		block16 ctr = J0;
-		block16 keystream {};
-		std::size_t unOutIndex = 0;
-
-		for (std::size_t unOffset = 0; unOffset < unDataSize; unOffset += 16) {
-			inc32_inplace(ctr);
-			keystream = AES256EncryptBlock(ctr, ks);
-
-			const std::size_t unChunk = (unOffset + 16 <= unDataSize) ? 16 : (unDataSize - unOffset);
-			for (std::size_t i = 0; i < unChunk; ++i) {
-				out.m_CipherText[unOutIndex + i] = static_cast<unsigned char>(pPlainText[unOffset + i] ^ keystream[i]);
-			}
-
-			unOutIndex += unChunk;
-		}
-
-		out.m_CipherTextSize = unOutIndex;
-
-		block16 S {};
-
-		if constexpr (unAADSize > 0) {
-			GHashAccamulate(H, pAAD, unAADSize, S);
-		}
-
-		if (out.m_CipherTextSize) {
-			GHashAccamulate(H, out.m_CipherText, out.m_CipherTextSize, S);
-		}
-
-		block16 lenblock {};
-
-		const unsigned long long unAADBits = static_cast<unsigned long long>(unAADSize) * 8ull;
-		const unsigned long long unCipherBits = static_cast<unsigned long long>(out.m_CipherTextSize) * 8ull;
-
-		for (unsigned char i = 0; i < 8; ++i) {
-			lenblock[i] = static_cast<unsigned char>((unAADBits >> (56 - 8 * i)) & 0xFF);
-		}
-
-		for (unsigned char i = 0; i < 8; ++i) {
-			lenblock[8 + i] = static_cast<unsigned char>((unCipherBits >> (56 - 8 * i)) & 0xFF);
-		}
-
-		for (unsigned char i = 0; i < 16; ++i) {
-			S[i] ^= lenblock[i];
-		}
-
-		S = GF128MulBE(S, H);
-
-		const block16 ENC_J0 = AES256EncryptBlock(J0, ks);
-		for (unsigned char i = 0; i < 16; ++i) {
-			out.m_Tag[i] = static_cast<unsigned char>(ENC_J0[i] ^ S[i]);
-		}
-
-		return out;
-	}
-
-	constexpr int compare_block16_ct(const block16& a, const block16& b) noexcept {
-		unsigned char unDiff = 0;
-		for (unsigned char i = 0; i < 16; ++i) {
-			unDiff |= a[i] ^ b[i];
-		}
-
-		return unDiff;
-	}
-
-	_CRYPTOSTRINGAES_FORCE_INLINE bool GCMDecrypt(const unsigned char* pCipherText, std::size_t unCipherTextSize, const unsigned char* pAAD, std::size_t unAADSize, const block16& tag, const block32& key, const iv12& iv, unsigned char* pPlainText) noexcept {
-		const block16 zero {};
-		const AES256KeySchedule ks(key);
-		const block16 H = AES256EncryptBlock(zero, ks);
-
-		block16 J0 {};
-		for (unsigned char i = 0; i < 12; ++i) {
-			J0[i] = iv[i];
-		}
-
-		J0[15] = 1;
-
-		block16 ctr = J0;
-		block16 keysteam {};
-
-		for (std::size_t unOffset = 0; unOffset < unCipherTextSize; unOffset += 16) {
-			inc32_inplace(ctr);
-			keysteam = AES256EncryptBlock(ctr, ks);
-
-			const std::size_t unChunk = (unOffset + 16 <= unCipherTextSize) ? 16 : (unCipherTextSize - unOffset);
-			for (std::size_t i = 0; i < unChunk; ++i) {
-				pPlainText[unOffset + i] = static_cast<unsigned char>(pCipherText[unOffset + i] ^ keysteam[i]);
-			}
-		}
-
-		block16 S {};
-		if (unAADSize > 0) {
-			GHashAccamulate(H, pAAD, unAADSize, S);
-		}
-
-		GHashAccamulate(H, pCipherText, unCipherTextSize, S);
-
-		block16 lenblock {};
-
-		const unsigned long long unAADBits = static_cast<unsigned long long>(unAADSize) * 8ull;
-		const unsigned long long unCipherBits = static_cast<unsigned long long>(unCipherTextSize) * 8ull;
-
-		for (unsigned char i = 0; i < 8; ++i) {
-			lenblock[i] = static_cast<unsigned char>((unAADBits >> (56 - 8 * i)) & 0xFF);
-		}
-
-		for (unsigned char i = 0; i < 8; ++i) {
-			lenblock[8 + i] = static_cast<unsigned char>((unCipherBits >> (56 - 8 * i)) & 0xFF);
-		}
-
-		for (unsigned char i = 0; i < 16; ++i) {
-			S[i] ^= lenblock[i];
-		}
-
-		S = GF128MulBE(S, H);
-
-		const block16 ENC_J0 = AES256EncryptBlock(J0, ks);
-
-		block16 computed_tag {};
-		for (unsigned char i = 0; i < 16; ++i) {
-			computed_tag[i] = static_cast<unsigned char>(ENC_J0[i] ^ S[i]);
-		}
-
-		return compare_block16_ct(computed_tag, tag) == 0;
-	}
+	template<class T>
+	using clean_type = std::remove_const_t<std::remove_reference_t<T>>;
 
 	constexpr unsigned int rotl32(unsigned int x, unsigned int n) noexcept {
 		return (x << n) | (x >> (32u - n));
@@ -541,11 +182,21 @@ namespace CryptoStringAES {
 	};
 
 	template<unsigned long long unLine, unsigned long long unCounter>
-	constexpr void BuildAESKey(block32& out) noexcept {
-		AdditionalKeyArrayAES<unLine, unCounter> extra {};
+	constexpr static void BuildAESKey(block32& out) noexcept {
+		// The site-specific half is folded at compile time, so each site carries 32 bytes of key material instead of 64.
+		constexpr block32 kSiteKey = [] {
+			AdditionalKeyArrayAES<unLine, unCounter> extra {};
+
+			block32 key {};
+			for (unsigned char i = 0; i < 32; ++i) {
+				key[i] = static_cast<unsigned char>(extra.m_Data[(i * 7) & 63] ^ extra.m_Data[(i * 13 + 5) & 63]);
+			}
+
+			return key;
+		}();
 
 		for (unsigned char i = 0; i < 32; ++i) {
-			out[i] = static_cast<unsigned char>(kBaseKey[i] ^ extra.m_Data[(i * 7) & 63] ^ extra.m_Data[(i * 13 + 5) & 63]);
+			out[i] = static_cast<unsigned char>(kBaseKey[i] ^ kSiteKey[i]);
 		}
 	}
 
@@ -568,6 +219,39 @@ namespace CryptoStringAES {
 		iv[11] = static_cast<unsigned char>( unY        & 0xFF);
 	}
 
+	template<unsigned long long unLine, unsigned long long unCounter>
+	constexpr static void BuildPrecomputedMask(Bytes<64>& out) noexcept {
+		AdditionalKeyArrayAES<unCounter, unLine> extra {};
+
+		for (unsigned char i = 0; i < 64; ++i) {
+			out[i] = static_cast<unsigned char>(kBaseKey[(i * 11) & 31] ^ extra.m_Data[(i * 29 + 3) & 63]);
+		}
+	}
+
+	// Writes all of pData to a file descriptor, retrying interrupted and partial writes.
+	inline bool WriteAll(int nFD, const void* pData, std::size_t unSize) noexcept {
+		const unsigned char* pBytes = static_cast<const unsigned char*>(pData);
+		while (unSize) {
+#if defined(_WIN32)
+			const int nWritten = _write(nFD, pBytes, static_cast<unsigned int>(unSize));
+#else
+			const ssize_t nWritten = ::write(nFD, pBytes, unSize);
+#endif
+			if (nWritten < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+
+				return false;
+			}
+
+			pBytes += nWritten;
+			unSize -= static_cast<std::size_t>(nWritten);
+		}
+
+		return true;
+	}
+
 	template<typename T, std::size_t N>
 	struct ByteIO;
 
@@ -616,16 +300,39 @@ namespace CryptoStringAES {
 		}
 	};
 
-	template <unsigned long long unLength, typename T, unsigned long long unLine = 0, unsigned long long unCounter = 0>
+	// Site classes read the TU-local key, so they are TU-local too; otherwise the linker keeps one TU's copy of each member.
+	namespace {
+
+	template <unsigned long long unLength, typename T, unsigned long long unLine = 0, unsigned long long unCounter = 0, Cipher eCipher = kDefaultCipher, class Profile = DefaultProfile, Verification eVerification = Verification::Always>
 	class CryptoStringAES {
 	private:
+		using Engine = Suite<eCipher>;
+
 		static constexpr std::size_t kLength = static_cast<std::size_t>(unLength);
 		static constexpr std::size_t kPlainBytes = kLength * sizeof(T);
+		static constexpr std::size_t kTextLength = (kLength > 0) ? (kLength - 1) : 0;
 
+		// Stored IV (if the profile keeps one), ciphertext, truncated tag and, with CRYPTOSTRINGAES_PRECOMPUTED, the masked key material.
 		struct EncryptedBlob {
-			unsigned char m_IV[12] {};
-			unsigned char m_CipherText[kPlainBytes] {};
-			unsigned char m_Tag[16] {};
+			static constexpr std::size_t kCipherTextOffset = Profile::kIVSize;
+			static constexpr std::size_t kTagOffset = kCipherTextOffset + kPlainBytes;
+			static constexpr std::size_t kPrecomputedOffset = kTagOffset + Profile::kTagSize;
+#ifdef CRYPTOSTRINGAES_PRECOMPUTED
+			static constexpr std::size_t kSize = kPrecomputedOffset + Engine::Precomputed::kSize;
+#else
+			static constexpr std::size_t kSize = kPrecomputedOffset;
+#endif
+
+			constexpr unsigned char* IV() noexcept { return m_Data; }
+			constexpr const unsigned char* IV() const noexcept { return m_Data; }
+			constexpr unsigned char* CipherText() noexcept { return m_Data + kCipherTextOffset; }
+			constexpr const unsigned char* CipherText() const noexcept { return m_Data + kCipherTextOffset; }
+			constexpr unsigned char* Tag() noexcept { return m_Data + kTagOffset; }
+			constexpr const unsigned char* Tag() const noexcept { return m_Data + kTagOffset; }
+			constexpr unsigned char* Precomputed() noexcept { return m_Data + kPrecomputedOffset; }
+			constexpr const unsigned char* Precomputed() const noexcept { return m_Data + kPrecomputedOffset; }
+
+			unsigned char m_Data[kSize] {};
 		};
 
 		static constexpr EncryptedBlob MakeBlob(const T* pData) noexcept {
@@ -650,56 +357,50 @@ namespace CryptoStringAES {
 				}
 			}
 
-			const auto encrypted = GCMEncrypt<kPlainBytes, kAADSize>(plaintext, kAAD, key, iv);
+			const auto encrypted = Engine::template Encrypt<kPlainBytes, kAADSize>(plaintext, kAAD, key, iv, Profile::kKeyBytes);
 
 			EncryptedBlob blob {};
-			for (unsigned char i = 0; i < 12; ++i) {
-				blob.m_IV[i] = iv[i];
+			if constexpr (Profile::kStoredIV) {
+				for (unsigned char i = 0; i < 12; ++i) {
+					blob.IV()[i] = iv[i];
+				}
 			}
 
 			for (std::size_t i = 0; i < kPlainBytes; ++i) {
-				blob.m_CipherText[i] = encrypted.m_CipherText[i];
+				blob.CipherText()[i] = encrypted.m_CipherText[i];
 			}
 
-			for (unsigned char i = 0; i < 16; ++i) {
-				blob.m_Tag[i] = encrypted.m_Tag[i];
+			for (std::size_t i = 0; i < Profile::kTagSize; ++i) {
+				blob.Tag()[i] = encrypted.m_Tag[i];
 			}
 
+#ifdef CRYPTOSTRINGAES_PRECOMPUTED
+			Bytes<64> mask {};
+			BuildPrecomputedMask<unLine, unCounter>(mask);
+
+			Engine::Precompute(key, iv, Profile::kKeyBytes).Store(blob.Precomputed(), mask);
+#endif
+
 			return blob;
 		}
 
 		static constexpr EncryptedBlob kBlobFrom(const T* pData) noexcept { return MakeBlob(pData); }
 
 	public:
+		using value_type = T;
+
+		static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
 		class DecryptedString {
 		public:
 			_CRYPTOSTRINGAES_FORCE_INLINE explicit DecryptedString(const CryptoStringAES& self) noexcept {
-				block32 key {};
-				BuildAESKey<unLine, unCounter>(key);
-
-				iv12 iv {};
-				for (unsigned char i = 0; i < 12; ++i) {
-					iv[i] = self.m_EncryptedBlob.m_IV[i];
-				}
-
-				block16 tag {};
-				for (unsigned char i = 0; i < 16; ++i) {
-					tag[i] = self.m_EncryptedBlob.m_Tag[i];
-				}
-
-				unsigned char plaintext[kPlainBytes] {};
-				if (!GCMDecrypt(self.m_EncryptedBlob.m_CipherText, kPlainBytes, kAAD, kAADSize, tag, key, iv, plaintext)) {
-					Clear();
-					return;
-				}
+				self.DecryptInto(m_Buffer);
+			}
 
+			// Copies plaintext that is already available (see CryptoRegistry::Decrypt).
+			_CRYPTOSTRINGAES_FORCE_INLINE explicit DecryptedString(const T* pPlainText) noexcept {
 				for (std::size_t i = 0; i < kLength; ++i) {
-					unsigned char bytes[sizeof(T)] {};
-					for (std::size_t j = 0; j < sizeof(T); ++j) {
-						bytes[j] = plaintext[i * sizeof(T) + j];
-					}
-
-					m_Buffer[i] = ByteIO<T, sizeof(T)>::from(bytes);
+					m_Buffer[i] = pPlainText[i];
 				}
 			}
 
@@ -747,23 +448,587 @@ namespace CryptoStringAES {
 			T m_Buffer[kLength] {};
 		};
 
+		// Handle on the site's decrypt-once plaintext. Every handle shares the same static storage, which stays
+		// readable until the last handle is gone; SealCaches/SealIdleCaches wipe it and the next handle decrypts again.
+		class CachedString {
+		public:
+			_CRYPTOSTRINGAES_FORCE_INLINE explicit CachedString(const CryptoStringAES& self) noexcept {
+				s_CacheGate.Acquire([&self]() noexcept {
+					const DecryptedString plain(self);
+					for (std::size_t i = 0; i < kLength; ++i) {
+						s_Cache[i] = plain[i];
+					}
+
+					RegisterCache(s_CacheEntry);
+				});
+			}
+
+			_CRYPTOSTRINGAES_FORCE_INLINE ~CachedString() noexcept {
+				if (m_bHeld) {
+					s_CacheGate.Release();
+				}
+			}
+
+			CachedString(const CachedString&) = delete;
+			CachedString& operator=(const CachedString&) = delete;
+
+			_CRYPTOSTRINGAES_FORCE_INLINE CachedString(CachedString&& other) noexcept : m_bHeld(other.m_bHeld) {
+				other.m_bHeld = false;
+			}
+
+			CachedString& operator=(CachedString&&) = delete;
+
+			_CRYPTOSTRINGAES_FORCE_INLINE const T* c_str() const noexcept { return s_Cache; }
+			_CRYPTOSTRINGAES_FORCE_INLINE operator const T* () const noexcept { return c_str(); }
+
+		private:
+			bool m_bHeld = true;
+		};
+
 		_CRYPTOSTRINGAES_FORCE_INLINE constexpr CryptoStringAES(const T* pData) noexcept : m_EncryptedBlob(kBlobFrom(pData)) {}
 		_CRYPTOSTRINGAES_FORCE_INLINE DecryptedString Decrypt() const noexcept { return DecryptedString(*this); }
+		_CRYPTOSTRINGAES_FORCE_INLINE CachedString Cached() const noexcept { return CachedString(*this); }
+
+		// Writes the kLength decrypted elements to pOut; all zero if the tag does not verify.
+		_CRYPTOSTRINGAES_FORCE_INLINE bool DecryptInto(T* pOut) const noexcept {
+			// Decrypt in place: element i is rebuilt from the bytes occupying its own storage.
+			unsigned char* pBytes = reinterpret_cast<unsigned char*>(pOut);
+			if (!DecryptBytes(pBytes)) {
+				return false;
+			}
+
+			if constexpr (sizeof(T) > 1) {
+				for (std::size_t i = 0; i < kLength; ++i) {
+					unsigned char bytes[sizeof(T)] {};
+					for (std::size_t j = 0; j < sizeof(T); ++j) {
+						bytes[j] = pBytes[i * sizeof(T) + j];
+					}
+
+					pOut[i] = ByteIO<T, sizeof(T)>::from(bytes);
+				}
+			}
+
+			return true;
+		}
+
+		// Writes the kLength decrypted elements straight into the caller's buffer, which holds unCapacity elements; returns the number
+		// written, or 0 when it is too small (buffer untouched) or the tag does not verify (buffer zeroed).
+		_CRYPTOSTRINGAES_FORCE_INLINE std::size_t DecryptTo(T* pDst, std::size_t unCapacity) const noexcept {
+			if (!pDst || (unCapacity < kLength)) {
+				return 0;
+			}
+
+			return DecryptInto(pDst) ? kLength : 0;
+		}
+
+		// Comparisons against the literal (without its terminator). The plaintext is decrypted one cache line at a time into a
+		// stack window that is wiped before returning, and the scan stops at the first difference; the tag is checked under the
+		// site's Verification policy first and a site that fails it compares unequal (npos from Find). Overloads without a
+		// length take a null-terminated text and compare the literal's terminator too, so they stop at the text's end.
+		_CRYPTOSTRINGAES_FORCE_INLINE bool Equals(const T* pText) const noexcept {
+			bool bEqual = true;
+			const bool bValid = VisitWindows(0, kLength, [&](const T* pWindow, std::size_t unFirst, std::size_t unElements) noexcept {
+				for (std::size_t i = 0; i < unElements; ++i) {
+					if (pWindow[i] != pText[unFirst + i]) {
+						bEqual = false;
+						return false;
+					}
+				}
+
+				return true;
+			});
+
+			return bValid && bEqual;
+		}
+
+		_CRYPTOSTRINGAES_FORCE_INLINE bool Equals(const T* pText, std::size_t unTextLength) const noexcept {
+			return (unTextLength == kTextLength) && (Mismatch(pText, 0, kTextLength) == kTextLength);
+		}
+
+		// Same result as Equals, but every window is decrypted and compared whatever the text.
+		_CRYPTOSTRINGAES_FORCE_INLINE bool EqualsConstantTime(const T* pText, std::size_t unTextLength) const noexcept {
+			if (unTextLength != kTextLength) {
+				return false;
+			}
+
+			Unit unDiff = 0;
+			const bool bValid = VisitWindows(0, kTextLength, [&](const T* pWindow, std::size_t unFirst, std::size_t unElements) noexcept {
+				for (std::size_t i = 0; i < unElements; ++i) {
+					unDiff |= static_cast<Unit>(pWindow[i]) ^ static_cast<Unit>(pText[unFirst + i]);
+				}
+
+				return true;
+			});
+
+			return bValid && (unDiff == 0);
+		}
+
+		// strcmp ordering (elements compared as unsigned): negative, zero or positive; 1 if the tag does not verify.
+		_CRYPTOSTRINGAES_FORCE_INLINE int Compare(const T* pText) const noexcept {
+			int nResult = 0;
+			const bool bValid = VisitWindows(0, kLength, [&](const T* pWindow, std::size_t unFirst, std::size_t unElements) noexcept {
+				for (std::size_t i = 0; i < unElements; ++i) {
+					const Unit unLiteral = static_cast<Unit>(pWindow[i]);
+					const Unit unText = static_cast<Unit>(pText[unFirst + i]);
+					if (unLiteral != unText) {
+						nResult = (unLiteral < unText) ? -1 : 1;
+						return false;
+					}
+				}
+
+				return true;
+			});
+
+			return bValid ? nResult : 1;
+		}
+
+		_CRYPTOSTRINGAES_FORCE_INLINE int Compare(const T* pText, std::size_t unTextLength) const noexcept {
+			int nResult = 0;
+			const std::size_t unCommon = (unTextLength < kTextLength) ? unTextLength : kTextLength;
+			const bool bValid = VisitWindows(0, unCommon, [&](const T* pWindow, std::size_t unFirst, std::size_t unElements) noexcept {
+				for (std::size_t i = 0; i < unElements; ++i) {
+					const Unit unLiteral = static_cast<Unit>(pWindow[i]);
+					const Unit unText = static_cast<Unit>(pText[unFirst + i]);
+					if (unLiteral != unText) {
+						nResult = (unLiteral < unText) ? -1 : 1;
+						return false;
+					}
+				}
+
+				return true;
+			});
+
+			if (!bValid) {
+				return 1;
+			}
+
+			if (nResult) {
+				return nResult;
+			}
+
+			return (kTextLength < unTextLength) ? -1 : ((kTextLength > unTextLength) ? 1 : 0);
+		}
+
+		// The literal starts with pPrefix.
+		_CRYPTOSTRINGAES_FORCE_INLINE bool StartsWith(const T* pPrefix, std::size_t unPrefixLength) const noexcept {
+			return (unPrefixLength <= kTextLength) && (Mismatch(pPrefix, 0, unPrefixLength) == unPrefixLength);
+		}
+
+		// pText starts with the literal.
+		_CRYPTOSTRINGAES_FORCE_INLINE bool IsPrefixOf(const T* pText, std::size_t unTextLength) const noexcept {
+			return (unTextLength >= kTextLength) && (Mismatch(pText, 0, kTextLength) == kTextLength);
+		}
+
+		// Position of the first occurrence of the literal in pText, or npos. The key is prepared and the tag checked once; the
+		// scan keeps one window, holding the start of the literal, and refills it with the rest only for matching candidates.
+		_CRYPTOSTRINGAES_FORCE_INLINE std::size_t Find(const T* pText, std::size_t unTextLength) const noexcept {
+			if (unTextLength < kTextLength) {
+				return npos;
+			}
+
+			if constexpr (kTextLength == 0) {
+				return 0;
+			} else {
+				constexpr std::size_t kHead = (kTextLength < kWindowElements) ? kTextLength : kWindowElements;
+
+				iv12 iv {};
+				LoadIV(iv);
+
+				typename Engine::Precomputed pre {};
+				PrepareKey(iv, pre);
+
+				std::size_t unFound = npos;
+				if (CheckTag(pre)) {
+					T window[kWindowElements] {};
+					DecryptWindow(pre, iv, 0, kHead, window);
+
+					for (std::size_t i = 0; i + kTextLength <= unTextLength; ++i) {
+						std::size_t j = 0;
+						for (; (j < kHead) && (window[j] == pText[i + j]); ++j) {}
+
+						if (j < kHead) {
+							continue;
+						}
+
+						if constexpr (kHead == kTextLength) {
+							unFound = i;
+							break;
+						} else {
+							bool bMatch = true;
+							for (std::size_t unIndex = kHead; bMatch && (unIndex < kTextLength); unIndex += kWindowElements) {
+								const std::size_t unElements = ((kTextLength - unIndex) < kWindowElements) ? (kTextLength - unIndex) : kWindowElements;
+								DecryptWindow(pre, iv, unIndex, unElements, window);
+
+								std::size_t k = 0;
+								for (; (k < unElements) && (window[k] == pText[i + unIndex + k]); ++k) {}
+
+								bMatch = (k == unElements);
+							}
+
+							if (bMatch) {
+								unFound = i;
+								break;
+							}
+
+							DecryptWindow(pre, iv, 0, kHead, window);
+						}
+					}
+
+					SecureWipe(window, sizeof(window));
+				}
+
+				SecureWipe(&pre, sizeof(pre));
+
+				return unFound;
+			}
+		}
+
+		// Streams the text (without its terminator) one 64-byte window at a time, so output starts before the rest is decrypted
+		// and no more than a window of plaintext exists outside the stream's own buffer. Sets failbit if the tag does not verify.
+		template<class Traits>
+		friend std::basic_ostream<T, Traits>& operator<<(std::basic_ostream<T, Traits>& Stream, const CryptoStringAES& self) {
+			std::exception_ptr pException;
+			const bool bValid = self.VisitWindows(0, kTextLength, [&](const T* pWindow, std::size_t, std::size_t unElements) noexcept {
+				try {
+					Stream.write(pWindow, static_cast<std::streamsize>(unElements));
+				} catch (...) {
+					pException = std::current_exception();
+					return false;
+				}
+
+				return Stream.good();
+			});
+
+			// Rethrown only once the window and key schedule have been wiped.
+			if (pException) {
+				std::rethrow_exception(pException);
+			}
+
+			if (!bValid) {
+				Stream.setstate(std::ios_base::failbit);
+			}
+
+			return Stream;
+		}
+
+		// Writes the raw elements of the text (without its terminator) to a file descriptor window by window; false on a write
+		// error or a tag that does not verify (nothing is written then).
+		_CRYPTOSTRINGAES_FORCE_INLINE bool WriteTo(int nFD) const noexcept {
+			bool bWritten = true;
+			const bool bValid = VisitWindows(0, kTextLength, [&](const T* pWindow, std::size_t, std::size_t unElements) noexcept {
+				bWritten = WriteAll(nFD, pWindow, unElements * sizeof(T));
+				return bWritten;
+			});
+
+			return bValid && bWritten;
+		}
+
+		static constexpr std::size_t size() noexcept { return kLength; }
 
 	private:
+		using Unit = std::conditional_t<sizeof(T) == 1, unsigned char, std::conditional_t<sizeof(T) == 2, unsigned short, unsigned int>>;
+
+		static constexpr std::size_t kWindowElements = 64 / sizeof(T);
+
+		// Decrypts elements [unFirst, unEnd) window by window and calls fnVisit(pWindow, unFirstInWindow, unElements) until it
+		// returns false. Returns false, without calling fnVisit, when the tag does not verify.
+		template<class Fn>
+		_CRYPTOSTRINGAES_FORCE_INLINE bool VisitWindows(std::size_t unFirst, std::size_t unEnd, Fn&& fnVisit) const noexcept {
+			iv12 iv {};
+			LoadIV(iv);
+
+			typename Engine::Precomputed pre {};
+			PrepareKey(iv, pre);
+
+			const bool bValid = CheckTag(pre);
+			if (bValid) {
+				T window[kWindowElements] {};
+
+				for (std::size_t unIndex = unFirst; unIndex < unEnd; unIndex += kWindowElements) {
+					const std::size_t unElements = ((unEnd - unIndex) < kWindowElements) ? (unEnd - unIndex) : kWindowElements;
+
+					DecryptWindow(pre, iv, unIndex, unElements, window);
+
+					if (!fnVisit(static_cast<const T*>(window), unIndex, unElements)) {
+						break;
+					}
+				}
+
+				SecureWipe(window, sizeof(window));
+			}
+
+			SecureWipe(&pre, sizeof(pre));
+
+			return bValid;
+		}
+
+		// Decrypts unElements elements starting at unIndex into pWindow with an already prepared key.
+		_CRYPTOSTRINGAES_FORCE_INLINE void DecryptWindow(const typename Engine::Precomputed& pre, const iv12& iv, std::size_t unIndex, std::size_t unElements, T* pWindow) const noexcept {
+			unsigned char* pBytes = reinterpret_cast<unsigned char*>(pWindow);
+
+			Engine::DecryptRange(pre, iv, m_EncryptedBlob.CipherText(), unIndex * sizeof(T), unElements * sizeof(T), pBytes);
+
+			if constexpr (sizeof(T) > 1) {
+				for (std::size_t i = 0; i < unElements; ++i) {
+					unsigned char bytes[sizeof(T)] {};
+					for (std::size_t j = 0; j < sizeof(T); ++j) {
+						bytes[j] = pBytes[i * sizeof(T) + j];
+					}
+
+					pWindow[i] = ByteIO<T, sizeof(T)>::from(bytes);
+				}
+			}
+		}
+
+		// Index of the first element in [unFirst, unEnd) that differs from pText, unEnd if none does, npos if the tag does not verify.
+		_CRYPTOSTRINGAES_FORCE_INLINE std::size_t Mismatch(const T* pText, std::size_t unFirst, std::size_t unEnd) const noexcept {
+			std::size_t unIndex = unEnd;
+			const bool bValid = VisitWindows(unFirst, unEnd, [&](const T* pWindow, std::size_t unWindowFirst, std::size_t unElements) noexcept {
+				for (std::size_t i = 0; i < unElements; ++i) {
+					if (pWindow[i] != pText[unWindowFirst + i]) {
+						unIndex = unWindowFirst + i;
+						return false;
+					}
+				}
+
+				return true;
+			});
+
+			return bValid ? unIndex : npos;
+		}
+
+		// Compact profiles drop the IV from the blob and re-derive it from unLine/unCounter.
+		_CRYPTOSTRINGAES_FORCE_INLINE void LoadIV(iv12& iv) const noexcept {
+			if constexpr (Profile::kStoredIV) {
+				for (unsigned char i = 0; i < 12; ++i) {
+					iv[i] = m_EncryptedBlob.IV()[i];
+				}
+			} else {
+				BuildGCMIV<unLine, unCounter>(iv);
+			}
+		}
+
+		_CRYPTOSTRINGAES_FORCE_INLINE void PrepareKey(const iv12& iv, typename Engine::Precomputed& pre) const noexcept {
+#ifdef CRYPTOSTRINGAES_PRECOMPUTED
+			static_cast<void>(iv);
+
+			Bytes<64> mask {};
+			BuildPrecomputedMask<unLine, unCounter>(mask);
+
+			Engine::Load(m_EncryptedBlob.Precomputed(), mask, pre);
+#else
+			block32 key {};
+			BuildAESKey<unLine, unCounter>(key);
+
+			Engine::Prepare(key, iv, pre, Profile::kKeyBytes);
+
+			SecureWipe(&key, sizeof(key));
+#endif
+		}
+
+		// Verify and decrypt in one pass; everything past building the site key happens out of line in CryptoAES::GCMOpen/ChaChaOpen.
+		_CRYPTOSTRINGAES_FORCE_INLINE bool OpenBytes(unsigned char* pPlainText) const noexcept {
+			iv12 iv {};
+			LoadIV(iv);
+
+			const GCMBlob blob { iv.data(), m_EncryptedBlob.CipherText(), kPlainBytes, m_EncryptedBlob.Tag(), Profile::kTagSize, Profile::kKeyBytes };
+
+#ifdef CRYPTOSTRINGAES_PRECOMPUTED
+			Bytes<64> mask {};
+			BuildPrecomputedMask<unLine, unCounter>(mask);
+
+			const bool bValid = Engine::Open(blob, m_EncryptedBlob.Precomputed(), mask, pPlainText);
+#else
+			block32 key {};
+			BuildAESKey<unLine, unCounter>(key);
+
+			const bool bValid = Engine::Open(blob, key, pPlainText);
+#endif
+			if (!bValid) {
+				ReportVerificationFailure(this);
+			}
+
+			return bValid;
+		}
+
+		// Keystream only, for sites whose tag is already (or will be) checked elsewhere.
+		_CRYPTOSTRINGAES_FORCE_INLINE void DecryptUnverified(unsigned char* pPlainText) const noexcept {
+			iv12 iv {};
+			LoadIV(iv);
+
+			typename Engine::Precomputed pre {};
+			PrepareKey(iv, pre);
+
+			Engine::DecryptRange(pre, iv, m_EncryptedBlob.CipherText(), 0, kPlainBytes, pPlainText);
+
+			SecureWipe(&pre, sizeof(pre));
+		}
+
+		_CRYPTOSTRINGAES_FORCE_INLINE bool VerifyTag(const typename Engine::Precomputed& pre) const noexcept {
+			block16 tag {};
+			for (std::size_t i = 0; i < Profile::kTagSize; ++i) {
+				tag[i] = m_EncryptedBlob.Tag()[i];
+			}
+
+			return Engine::Verify(m_EncryptedBlob.CipherText(), kPlainBytes, kAAD, kAADSize, tag, pre, Profile::kTagSize);
+		}
+
+		// Runs from VerifyPending() for Batched sites.
+		static bool VerifyQueued(const void* pSite) noexcept {
+			const CryptoStringAES* pSelf = static_cast<const CryptoStringAES*>(pSite);
+
+			iv12 iv {};
+			pSelf->LoadIV(iv);
+
+			typename Engine::Precomputed pre {};
+			pSelf->PrepareKey(iv, pre);
+
+			const bool bValid = pSelf->VerifyTag(pre);
+
+			SecureWipe(&pre, sizeof(pre));
+
+			s_nVerified.store(bValid ? 1 : -1, std::memory_order_release);
+			if (!bValid) {
+				ReportVerificationFailure(pSite);
+			}
+
+			return bValid;
+		}
+
+		// pPlainText is zeroed on failure.
+		_CRYPTOSTRINGAES_FORCE_INLINE bool DecryptBytes(unsigned char* pPlainText) const noexcept {
+			if constexpr (eVerification == Verification::Always) {
+				return OpenBytes(pPlainText);
+			} else {
+				const signed char nState = s_nVerified.load(std::memory_order_acquire);
+				if (nState < 0) {
+					SecureWipe(pPlainText, kPlainBytes);
+					return false;
+				}
+
+				if constexpr (eVerification == Verification::OncePerSite) {
+					if (nState == 0) {
+						const bool bValid = OpenBytes(pPlainText);
+						s_nVerified.store(bValid ? 1 : -1, std::memory_order_release);
+						return bValid;
+					}
+				} else if (nState == 0) {
+					QueueVerification(s_VerificationJob, this);
+				}
+
+				DecryptUnverified(pPlainText);
+				return true;
+			}
+		}
+
+		// The windowed comparisons' counterpart of DecryptBytes: same policy, but the tag is checked on its own with pre.
+		_CRYPTOSTRINGAES_FORCE_INLINE bool CheckTag(const typename Engine::Precomputed& pre) const noexcept {
+			if constexpr (eVerification != Verification::Always) {
+				const signed char nState = s_nVerified.load(std::memory_order_acquire);
+				if (nState != 0) {
+					return nState > 0;
+				}
+
+				if constexpr (eVerification == Verification::Batched) {
+					QueueVerification(s_VerificationJob, this);
+					return true;
+				}
+			}
+
+			const bool bValid = VerifyTag(pre);
+			if constexpr (eVerification == Verification::OncePerSite) {
+				s_nVerified.store(bValid ? 1 : -1, std::memory_order_release);
+			}
+
+			if (!bValid) {
+				ReportVerificationFailure(this);
+			}
+
+			return bValid;
+		}
+
+		// 0 until the tag has been checked, then 1 or -1 (unused by Verification::Always).
+		static inline std::atomic<signed char> s_nVerified { 0 };
+		// Both are per TU like the class, so one TU's result or queued job never stands in for another TU's site.
+		static inline VerificationJob s_VerificationJob { &VerifyQueued, nullptr, nullptr, {} };
+
+		static bool SealCache() noexcept {
+			return s_CacheGate.Seal([]() noexcept { SecureWipe(s_Cache, sizeof(s_Cache)); });
+		}
+
+		// Decrypted copy for the _CACHED macros; per TU like the class, since __LINE__/__COUNTER__ repeat across TUs.
+		static inline T s_Cache[kLength] {};
+		static inline CacheGate s_CacheGate {};
+		static inline CacheEntry s_CacheEntry { &s_CacheGate, &SealCache, nullptr, {} };
+
 		EncryptedBlob m_EncryptedBlob {};
 	};
 
+	} // namespace
+
 } // namespace CryptoStringAES
 
-#define _CRYPTOSTRINGAES(STRING)                                                                                                                                \
-	([]() -> auto {                                                                                                                                             \
+#ifdef CRYPTOREGISTRY
+#define _CRYPTOSTRINGAES(STRING, CIPHER, PROFILE)                                                                                                                                       \
+	([]() -> auto {                                                                                                                                                                     \
+		constexpr std::size_t unLength = std::extent_v<std::remove_reference_t<decltype(STRING)>>;                                                                                      \
+		static constexpr auto Encrypted = CryptoStringAES::CryptoStringAES<unLength, CryptoStringAES::clean_type<decltype(STRING[0])>, __LINE__, __COUNTER__, CIPHER, PROFILE>(STRING); \
+		_CRYPTOREGISTRY_SITE(Encrypted, CryptoRegistry::Kind::StringAES);                                                                                                               \
+		return CryptoRegistry::Decrypt(Encrypted, RegistryEntry);                                                                                                                       \
+	}())
+#else
+#define _CRYPTOSTRINGAES(STRING, CIPHER, PROFILE)                                                                                                                                \
+	([]() -> auto {                                                                                                                                                              \
+		constexpr std::size_t unLength = std::extent_v<std::remove_reference_t<decltype(STRING)>>;                                                                               \
+		constexpr auto Encrypted = CryptoStringAES::CryptoStringAES<unLength, CryptoStringAES::clean_type<decltype(STRING[0])>, __LINE__, __COUNTER__, CIPHER, PROFILE>(STRING); \
+		return Encrypted.Decrypt();                                                                                                                                              \
+	}())
+#endif
+
+#define _CRYPTOSTRINGAES_CACHED(STRING, CIPHER, PROFILE)                                                                                                                                \
+	([]() -> auto {                                                                                                                                                                     \
+		constexpr std::size_t unLength = std::extent_v<std::remove_reference_t<decltype(STRING)>>;                                                                                      \
+		static constexpr auto Encrypted = CryptoStringAES::CryptoStringAES<unLength, CryptoStringAES::clean_type<decltype(STRING[0])>, __LINE__, __COUNTER__, CIPHER, PROFILE>(STRING); \
+		return Encrypted.Cached();                                                                                                                                                      \
+	}())
+
+#define _CRYPTOSTRINGAES_VERIFIED(STRING, VERIFICATION)                                                                                                                                                                                    \
+	([]() -> auto {                                                                                                                                                                                                                        \
+		constexpr std::size_t unLength = std::extent_v<std::remove_reference_t<decltype(STRING)>>;                                                                                                                                         \
+		static constexpr auto Encrypted = CryptoStringAES::CryptoStringAES<unLength, CryptoStringAES::clean_type<decltype(STRING[0])>, __LINE__, __COUNTER__, CryptoAES::kDefaultCipher, CryptoAES::DefaultProfile, VERIFICATION>(STRING); \
+		return Encrypted.Decrypt();                                                                                                                                                                                                        \
+	}())
+
+#define _CRYPTOSTRINGAES_POOLED(STRING)                                                                                                                                                                                                            \
+	([]() -> auto {                                                                                                                                                                                                                                \
+		constexpr std::size_t unLength = std::extent_v<std::remove_reference_t<decltype(STRING)>>;                                                                                                                                                 \
+		_CRYPTOSTRINGAES_POOL static constexpr auto Encrypted = CryptoStringAES::CryptoStringAES<unLength, CryptoStringAES::clean_type<decltype(STRING[0])>, __LINE__, __COUNTER__, CryptoAES::Cipher::AESGCM, CryptoAES::CompactProfile>(STRING); \
+		return Encrypted.Decrypt();                                                                                                                                                                                                                \
+	}())
+
+#define _CRYPTOSTRINGAES_TO(STRING, DST, CAP)                                                                                                                   \
+	([&]() -> std::size_t {                                                                                                                                     \
 		constexpr std::size_t unLength = std::extent_v<std::remove_reference_t<decltype(STRING)>>;                                                              \
 		constexpr auto Encrypted = CryptoStringAES::CryptoStringAES<unLength, CryptoStringAES::clean_type<decltype(STRING[0])>, __LINE__, __COUNTER__>(STRING); \
-		return Encrypted.Decrypt();                                                                                                                             \
+		return Encrypted.DecryptTo((DST), (CAP));                                                                                                               \
+	}())
+
+#define _CRYPTOSTRINGAES_ENCRYPTED(STRING, CIPHER, PROFILE)                                                                                                                             \
+	([]() -> const auto& {                                                                                                                                                              \
+		constexpr std::size_t unLength = std::extent_v<std::remove_reference_t<decltype(STRING)>>;                                                                                      \
+		static constexpr auto Encrypted = CryptoStringAES::CryptoStringAES<unLength, CryptoStringAES::clean_type<decltype(STRING[0])>, __LINE__, __COUNTER__, CIPHER, PROFILE>(STRING); \
+		return Encrypted;                                                                                                                                                               \
 	}())
 
-#define CRYPTOSTRINGAES(STRING) _CRYPTOSTRINGAES(STRING)
+#define CRYPTOSTRINGAES(STRING) _CRYPTOSTRINGAES(STRING, CryptoAES::kDefaultCipher, CryptoAES::DefaultProfile)
+#define CRYPTOSTRINGAES_CHACHA20(STRING) _CRYPTOSTRINGAES(STRING, CryptoAES::Cipher::ChaCha20Poly1305, CryptoAES::DefaultProfile)
+#define CRYPTOSTRINGAES_COMPACT(STRING) _CRYPTOSTRINGAES(STRING, CryptoAES::Cipher::AESGCM, CryptoAES::CompactProfile)
+#define CRYPTOSTRINGAES_POOLED(STRING) _CRYPTOSTRINGAES_POOLED(STRING)
+#define CRYPTOSTRINGAES_CACHED(STRING) _CRYPTOSTRINGAES_CACHED(STRING, CryptoAES::kDefaultCipher, CryptoAES::DefaultProfile)
+#define CRYPTOSTRINGAES_VERIFY_ONCE(STRING) _CRYPTOSTRINGAES_VERIFIED(STRING, CryptoAES::Verification::OncePerSite)
+#define CRYPTOSTRINGAES_VERIFY_BATCHED(STRING) _CRYPTOSTRINGAES_VERIFIED(STRING, CryptoAES::Verification::Batched)
+#define CRYPTOSTRINGAES_TO(STRING, DST, CAP) _CRYPTOSTRINGAES_TO(STRING, DST, CAP)
+#define CRYPTOSTRINGAES_ENCRYPTED(STRING) _CRYPTOSTRINGAES_ENCRYPTED(STRING, CryptoAES::kDefaultCipher, CryptoAES::DefaultProfile)
 
 #undef _CRYPTOSTRINGAES_FORCE_INLINE
 #undef _CRYPTOSTRINGAES_NO_INLINE
@@ -85,19 +85,12 @@ namespace StackString {
 		static constexpr std::size_t kPlainBytes = kLength * sizeof(T);
 
 	public:
+		using value_type = T;
+
 		class DecryptedString {
 		public:
 			_STACKSTRING_FORCE_INLINE explicit DecryptedString(const StackString& enc) noexcept {
-				for (std::size_t i = 0; i < kLength; ++i) {
-					unsigned char tmp[sizeof(T)] {};
-
-					for (std::size_t k = 0; k < sizeof(T); ++k) {
-						const std::size_t j = i * sizeof(T) + k;
-						tmp[k] = enc.m_Storage[j] ^ 0xFF;
-					}
-
-					m_Buffer[i] = ByteIO<T, sizeof(T)>::from(tmp);
-				}
+				enc.DecryptInto(m_Buffer);
 			}
 
 			_STACKSTRING_FORCE_INLINE ~DecryptedString() noexcept {
@@ -172,6 +165,34 @@ namespace StackString {
 			return DecryptedString(*this);
 		}
 
+		// Writes the kLength decoded elements to pOut.
+		_STACKSTRING_FORCE_INLINE bool DecryptInto(T* pOut) const noexcept {
+			for (std::size_t i = 0; i < kLength; ++i) {
+				unsigned char tmp[sizeof(T)] {};
+
+				for (std::size_t k = 0; k < sizeof(T); ++k) {
+					const std::size_t j = i * sizeof(T) + k;
+					tmp[k] = m_Storage[j] ^ 0xFF;
+				}
+
+				pOut[i] = ByteIO<T, sizeof(T)>::from(tmp);
+			}
+
+			return true;
+		}
+
+		// Writes the kLength decoded elements straight into the caller's buffer, which holds unCapacity elements; returns the number
+		// written, or 0 (buffer untouched) when it is too small.
+		_STACKSTRING_FORCE_INLINE std::size_t DecryptTo(T* pDst, std::size_t unCapacity) const noexcept {
+			if (!pDst || (unCapacity < kLength)) {
+				return 0;
+			}
+
+			return DecryptInto(pDst) ? kLength : 0;
+		}
+
+		static constexpr std::size_t size() noexcept { return kLength; }
+
 	private:
 		unsigned char m_Storage[kPlainBytes] {};
 	};
@@ -187,6 +208,15 @@ namespace StackString {
 
 #define STACKSTRING(STRING) _STACKSTRING(STRING)
 
+#define _STACKSTRING_TO(STRING, DST, CAP)                                                                                                                                                                      \
+	([&]() -> std::size_t {                                                                                                                                                                                    \
+		constexpr size_t unLength = std::extent_v<std::remove_reference_t<decltype(STRING)>>;                                                                                                                  \
+		constexpr auto Encrypted = StackString::StackString<unLength, StackString::clean_type<decltype(STRING[0])>, __LINE__, __COUNTER__>(const_cast<StackString::clean_type<decltype(STRING[0])>*>(STRING)); \
+		return Encrypted.DecryptTo((DST), (CAP));                                                                                                                                                              \
+	} ())
+
+#define STACKSTRING_TO(STRING, DST, CAP) _STACKSTRING_TO(STRING, DST, CAP)
+
 #undef _STACKSTRING_FORCE_INLINE
 #undef _STACKSTRING_NO_INLINE
 
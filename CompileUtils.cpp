@@ -79,22 +79,6 @@ exit:
 constexpr auto lowered = RV32I_LOWERCASE("HELLO, WORLD!");
 static_assert(lowered[0] == 'h' && lowered[1] == 'e' && lowered[12] == '!', "lowercase failed");
 
-__forceinline int own_strcmp(const char* s1, const char* s2) noexcept {
-	const unsigned char* p1 = reinterpret_cast<const unsigned char*>(s1);
-	const unsigned char* p2 = reinterpret_cast<const unsigned char*>(s2);
-
-	while (*p1 == *p2) {
-		if (*p1 == '\0') {
-			return 0;
-		}
-
-		++p1;
-		++p2;
-	}
-
-	return static_cast<int>(*p1) - static_cast<int>(*p2);
-}
-
 constexpr unsigned int kArray[] = {
 	HASHSTRING32("Hello"),
 	0,
@@ -102,16 +86,16 @@ constexpr unsigned int kArray[] = {
 };
 
 int main() {
-	std::wcout << CRYPTOSTRINGAES(L"Enter password: ").c_str();
+	std::wcout << CRYPTOSTRINGAES_ENCRYPTED(L"Enter password: ");
 	std::string EnteredPassword;
 	std::getline(std::cin, EnteredPassword);
 
 	std::cout << STACKSTRING("Your password: ") << EnteredPassword << std::endl;
 
-	if (own_strcmp(EnteredPassword.c_str(), CRYPTOSTRING("SecureLogon32")) == 0) {
-		std::wcout << CRYPTOSTRINGAES(L"Access granted!").c_str() << std::endl;
+	if (CRYPTOSTRING_ENCRYPTED("SecureLogon32").EqualsConstantTime(EnteredPassword.c_str(), EnteredPassword.size())) {
+		std::wcout << CRYPTOSTRINGAES_ENCRYPTED(L"Access granted!") << std::endl;
 	} else {
-		std::wcout << CRYPTOSTRINGAES(L"Access denied! Incorrect password.").c_str() << std::endl;
+		std::wcout << CRYPTOSTRINGAES_ENCRYPTED(L"Access denied! Incorrect password.") << std::endl;
 	}
 
 	auto arr = CRYPTOARRAY(kArray);